@@ -0,0 +1,289 @@
+/**
+  ******************************************************************************
+  * @file    arithmetic.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <cctype>
+
+#include "arithmetic.hpp"
+
+#define ARITHMETIC_MAX_PENDING 6 /**< the maximum number of binary operators waiting for their right operand (one per precedence level). */
+#define ARITHMETIC_MAX_UNARY 16 /**< the maximum number of unary operators in front of a literal. */
+
+bool readIntegerLiteral(const char* str, std::size_t size, IntegerValue& value)
+{
+    bool unsignedSuffix = false;
+
+    while(size > 0 && (str[size-1]=='u' || str[size-1]=='U' || str[size-1]=='l' || str[size-1]=='L'))
+    {
+        if(str[size-1]=='u' || str[size-1]=='U')
+            unsignedSuffix = true;
+        --size;
+    }
+
+    unsigned base = 10;
+    std::size_t i = 0;
+
+    if(size >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')){
+        base = 16;
+        i = 2;
+    }
+    else if(size >= 2 && str[0] == '0' && (str[1] == 'b' || str[1] == 'B')){
+        base = 2;
+        i = 2;
+    }
+    else if(size >= 2 && str[0] == '0'){
+        base = 8;
+        i = 1;
+    }
+
+    std::uint64_t result = 0;
+    bool oneDigit = false;
+
+    for(; i<size; ++i)
+    {
+        char c = str[i];
+        unsigned digit;
+
+        if(c == '\'' && oneDigit)
+            continue;
+        else if(c >= '0' && c <= '9')
+            digit = c - '0';
+        else if(c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else
+            return false;
+
+        if(digit >= base || result > (UINT64_MAX - digit) / base)
+            return false;
+
+        result = result*base + digit;
+        oneDigit = true;
+    }
+
+    if(!oneDigit)
+        return false;
+
+    // A literal too large for an intmax_t is an uintmax_t, like with the usual compilers
+    value.bits = result;
+    value.isUnsigned = (unsignedSuffix || result > static_cast<std::uint64_t>(INT64_MAX));
+    return true;
+}
+
+bool applyArithmeticOperator(ArithmeticOperator op, IntegerValue& left, const IntegerValue& right)
+{
+    // The shifts keep the type of their left operand
+    if(op == ArithmeticOperator::SHIFT_LEFT || op == ArithmeticOperator::SHIFT_RIGHT)
+    {
+        if((!right.isUnsigned && right.asSigned() < 0) || right.bits >= 64)
+            return false;
+
+        const unsigned count = static_cast<unsigned>(right.bits);
+
+        if(op == ArithmeticOperator::SHIFT_LEFT)
+            left.bits <<= count;
+        else if(left.isUnsigned || left.asSigned() >= 0)
+            left.bits >>= count;
+        else
+            left.bits = ~(~left.bits >> count); // the sign is extended
+
+        return true;
+    }
+
+    // The other operators convert both operands to a common type
+    const std::uint64_t l = left.bits;
+    const std::uint64_t r = right.bits;
+    const std::int64_t sl = left.asSigned();
+    const std::int64_t sr = right.asSigned();
+    const bool isUnsigned = (left.isUnsigned || right.isUnsigned);
+
+    left.isUnsigned = isUnsigned;
+
+    switch(op)
+    {
+        // The overflows wrap around, the operations are done on the two's complement representations
+        case ArithmeticOperator::PLUS: left.bits = l + r; break;
+        case ArithmeticOperator::MINUS: left.bits = l - r; break;
+        case ArithmeticOperator::MULTIPLY: left.bits = l * r; break;
+
+        case ArithmeticOperator::DIVIDE:
+        case ArithmeticOperator::MODULO:
+            if(r == 0 || (!isUnsigned && sl == INT64_MIN && sr == -1))
+                return false;
+
+            if(isUnsigned)
+                left.bits = (op == ArithmeticOperator::DIVIDE ? l / r : l % r);
+            else
+                left.bits = static_cast<std::uint64_t>(op == ArithmeticOperator::DIVIDE ? sl / sr : sl % sr);
+            break;
+
+        case ArithmeticOperator::BIT_AND: left.bits = l & r; break;
+        case ArithmeticOperator::BIT_XOR: left.bits = l ^ r; break;
+        case ArithmeticOperator::BIT_OR: left.bits = l | r; break;
+
+        case ArithmeticOperator::LESS: left.bits = (isUnsigned ? l < r : sl < sr); break;
+        case ArithmeticOperator::GREATER: left.bits = (isUnsigned ? l > r : sl > sr); break;
+        case ArithmeticOperator::LESS_EQUAL: left.bits = (isUnsigned ? l <= r : sl <= sr); break;
+        case ArithmeticOperator::GREATER_EQUAL: left.bits = (isUnsigned ? l >= r : sl >= sr); break;
+        case ArithmeticOperator::EQUAL: left.bits = (l == r); break;
+        case ArithmeticOperator::NOT_EQUAL: left.bits = (l != r); break;
+
+        default: return false;
+    }
+
+    // The result of a comparison is an intmax_t
+    if(op >= ArithmeticOperator::LESS && op <= ArithmeticOperator::NOT_EQUAL)
+        left.isUnsigned = false;
+
+    return true;
+}
+
+void negateInteger(IntegerValue& value)
+{
+    value.bits = 0 - value.bits;
+}
+
+void complementInteger(IntegerValue& value)
+{
+    value.bits = ~value.bits;
+}
+
+/** \brief the precedence of a binary operator accepted in the expressions without parentheses.
+ */
+static int precedenceOf(ArithmeticOperator op)
+{
+    switch(op)
+    {
+        case ArithmeticOperator::MULTIPLY: case ArithmeticOperator::DIVIDE: case ArithmeticOperator::MODULO: return 5;
+        case ArithmeticOperator::PLUS: case ArithmeticOperator::MINUS: return 4;
+        case ArithmeticOperator::SHIFT_LEFT: case ArithmeticOperator::SHIFT_RIGHT: return 3;
+        case ArithmeticOperator::BIT_AND: return 2;
+        case ArithmeticOperator::BIT_XOR: return 1;
+        default: return 0;
+    }
+}
+
+/** \brief read the binary operator at a position of the expression (comparisons are not accepted).
+ *
+ * \param position the position of the operator, it is moved after it.
+ * \return false if there is no binary operator accepted at this position.
+ */
+static bool readBinaryOperator(const char* str, std::size_t size, std::size_t& position, ArithmeticOperator& op)
+{
+    const char c = str[position++];
+
+    switch(c)
+    {
+        case '+': op = ArithmeticOperator::PLUS; return true;
+        case '-': op = ArithmeticOperator::MINUS; return true;
+        case '*': op = ArithmeticOperator::MULTIPLY; return true;
+        case '/': op = ArithmeticOperator::DIVIDE; return true;
+        case '%': op = ArithmeticOperator::MODULO; return true;
+        case '&': op = ArithmeticOperator::BIT_AND; return (position >= size || str[position] != '&');
+        case '^': op = ArithmeticOperator::BIT_XOR; return true;
+        case '|': op = ArithmeticOperator::BIT_OR; return (position >= size || str[position] != '|');
+
+        case '<':
+        case '>':
+            if(position >= size || str[position] != c)
+                return false;
+            ++position;
+            op = (c == '<' ? ArithmeticOperator::SHIFT_LEFT : ArithmeticOperator::SHIFT_RIGHT);
+            return true;
+
+        default: return false;
+    }
+}
+
+bool evaluateIntegerExpression(const char* str, std::size_t size, IntegerValue& result)
+{
+    // The operators waiting for their right operand and their left operands, their precedences are increasing
+    IntegerValue operands[ARITHMETIC_MAX_PENDING];
+    ArithmeticOperator operators[ARITHMETIC_MAX_PENDING];
+    std::size_t nbPending = 0;
+    std::size_t position = 0;
+
+    while(true)
+    {
+        char unary[ARITHMETIC_MAX_UNARY];
+        std::size_t nbUnary = 0;
+
+        while(position < size && (str[position] == '+' || str[position] == '-' || str[position] == '~'))
+        {
+            if(nbUnary == ARITHMETIC_MAX_UNARY)
+                return false;
+            unary[nbUnary++] = str[position++];
+        }
+
+        // Let's take every character that may belong to the literal, readIntegerLiteral() rejects the wrong ones
+        const std::size_t start = position;
+        if(position >= size || !isdigit(static_cast<unsigned char>(str[position])))
+            return false;
+
+        while(position < size && (isalnum(static_cast<unsigned char>(str[position])) || str[position] == '\''))
+            ++position;
+
+        IntegerValue operand;
+        if(!readIntegerLiteral(str+start, position-start, operand))
+            return false;
+
+        // The closest unary operator applies first
+        while(nbUnary > 0)
+        {
+            const char c = unary[--nbUnary];
+            if(c == '-')
+                negateInteger(operand);
+            else if(c == '~')
+                complementInteger(operand);
+        }
+
+        const bool end = (position >= size);
+        ArithmeticOperator op = ArithmeticOperator::BIT_OR;
+
+        if(!end && !readBinaryOperator(str, size, position, op))
+            return false;
+
+        // The pending operators that have a higher or equal precedence are applied first (left to right)
+        while(nbPending > 0 && (end || precedenceOf(operators[nbPending-1]) >= precedenceOf(op)))
+        {
+            --nbPending;
+            if(!applyArithmeticOperator(operators[nbPending], operands[nbPending], operand))
+                return false;
+            operand = operands[nbPending];
+        }
+
+        if(end)
+        {
+            result = operand;
+            return true;
+        }
+
+        operands[nbPending] = operand;
+        operators[nbPending] = op;
+        ++nbPending;
+    }
+}
+
+std::string integerToString(const IntegerValue& value)
+{
+    if(value.isUnsigned)
+        return std::to_string(static_cast<unsigned long long>(value.bits));
+
+    return std::to_string(static_cast<long long>(value.asSigned()));
+}
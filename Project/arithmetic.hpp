@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    arithmetic.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef ARITHMETIC_HPP
+#define ARITHMETIC_HPP
+
+/// This file describes the integer arithmetic of the preprocessor, shared by every evaluation of expressions.
+/// Every value is an intmax_t or an uintmax_t (64 bits), and the usual arithmetic conversions apply:
+/// if one of the operands is unsigned, both of them are converted to unsigned.
+/// Each operation is done in constant time, without any stream nor heap allocation.
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**< an integer value and its type. */
+struct IntegerValue
+{
+    /**< the value, stored as its two's complement representation. */
+    std::uint64_t bits;
+    /**< true if it is an uintmax_t, false if it is an intmax_t. */
+    bool isUnsigned;
+
+    inline std::int64_t asSigned() const { return static_cast<std::int64_t>(bits); }
+    inline bool isTrue() const { return bits != 0; }
+};
+
+/**< the binary operators of the integer arithmetic. */
+enum class ArithmeticOperator { PLUS, MINUS, MULTIPLY, DIVIDE, MODULO, SHIFT_LEFT, SHIFT_RIGHT,
+                                LESS, GREATER, LESS_EQUAL, GREATER_EQUAL, EQUAL, NOT_EQUAL,
+                                BIT_AND, BIT_XOR, BIT_OR };
+
+/** \brief read an integer literal: decimal, hexadecimal (0x), octal (leading 0) or binary (0b).
+ *         The literal is unsigned if it has a 'U' suffix or if it is too large for an intmax_t.
+ *         The other suffixes (L, LL) and the digit separators are ignored.
+ *
+ * \param str the first character of the literal.
+ * \param size the number of characters of the literal.
+ * \param value the value read.
+ * \return false if it is not an integer literal (floating point value for instance), or if it does not fit in 64 bits.
+ */
+bool readIntegerLiteral(const char* str, std::size_t size, IntegerValue& value);
+
+/** \brief compute "left op right", the result is stored in left.
+ *         The comparisons give 0 or 1 (as an intmax_t).
+ *
+ * \return false if the result is undefined: division by zero, INTMAX_MIN/-1, negative shift count or shift count too large.
+ */
+bool applyArithmeticOperator(ArithmeticOperator op, IntegerValue& left, const IntegerValue& right);
+
+/** \brief compute "-value", the result is stored in value (it keeps its type).
+ */
+void negateInteger(IntegerValue& value);
+
+/** \brief compute "~value", the result is stored in value (it keeps its type).
+ */
+void complementInteger(IntegerValue& value);
+
+/** \brief evaluate an arithmetic expression made of integer literals, of the unary operators + - ~ and of the binary operators
+ *         + - * / % << >> & ^ | (the usual precedences apply). Spaces, parentheses and comparisons are not accepted.
+ *
+ * \param str the expression.
+ * \param size the number of characters of the expression.
+ * \param result the value of the expression.
+ * \return false if the expression is incorrect, contains something else, or if its value is undefined.
+ */
+bool evaluateIntegerExpression(const char* str, std::size_t size, IntegerValue& result);
+
+/** \brief write an integer value in decimal.
+ */
+std::string integerToString(const IntegerValue& value);
+
+#endif // ARITHMETIC_HPP
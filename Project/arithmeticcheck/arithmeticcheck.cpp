@@ -0,0 +1,327 @@
+/**
+  ******************************************************************************
+  * @file    arithmeticcheck.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/// A check of the integer arithmetic of the preprocessor (arithmetic.hpp), it is a program of its own, built from the folder Project:
+/// g++ -std=c++11 -O2 -pthread arithmeticcheck/arithmeticcheck.cpp arithmetic.cpp stringeval.cpp tokeneval.cpp literals.cpp container.cpp
+///     definitiontable.cpp stringpool.cpp strings.cpp options.cpp threadpool.cpp closestr.cpp -o ArithmeticCheck
+/// - random expressions are computed by evaluateIntegerExpression(), and by the compiler in #if directives (value and signedness).
+/// - the expressions the legacy evaluator (evaluateSimpleArithmeticExpr, on doubles) computes exactly must give the same values.
+/// - both of them are timed on a few expressions.
+/// Usage: ArithmeticCheck [--count n] [--seed s] [--compiler "cc -E -P -w"] (exit code 0 when every value matches).
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../arithmetic.hpp"
+#include "../stringeval.hpp"
+
+#define CHECK_MAX_OPERANDS 8 /**< the maximum number of literals of a random expression. */
+#define CHECK_LEGACY_MAX_OPERANDS 4 /**< the legacy evaluator stays exact as long as the values stay below 2^53. */
+#define CHECK_BENCHMARK_ITERATIONS 200000 /**< the number of evaluations of each expression timed. */
+
+/**< an expression, written for the kernel (without spaces) and for the compiler (with spaces, so that "- -" is not read as "--"). */
+struct CheckedExpression
+{
+    std::string compact;
+    std::string spaced;
+};
+
+/**< builds random expressions. */
+class ExpressionGenerator
+{
+public:
+    explicit ExpressionGenerator(unsigned long long seed)
+    : random(seed)
+    {}
+
+    /** \brief build an expression using every operator of the kernel, with literals of every base and type.
+     */
+    CheckedExpression makeExpression()
+    {
+        static const char* const operators[] = { "+", "-", "*", "/", "%", "<<", ">>", "&", "^", "|" };
+
+        CheckedExpression expr;
+        const unsigned nbOperands = 1 + pick(CHECK_MAX_OPERANDS);
+
+        for(unsigned i=0; i<nbOperands; ++i)
+        {
+            std::string op;
+            if(i > 0){
+                op = operators[pick(10)];
+                append(expr, op);
+            }
+
+            // The shift counts are kept small, most of them would not be computable otherwise
+            if(op == "<<" || op == ">>")
+                append(expr, std::to_string(pick(64)));
+            else
+                appendOperand(expr);
+        }
+
+        return expr;
+    }
+
+    /** \brief build an expression the legacy evaluator computes exactly: small decimal literals, + - * and unary minus.
+     */
+    CheckedExpression makeLegacyExpression()
+    {
+        static const char* const operators[] = { "+", "-", "*" };
+
+        CheckedExpression expr;
+        const unsigned nbOperands = 1 + pick(CHECK_LEGACY_MAX_OPERANDS);
+
+        for(unsigned i=0; i<nbOperands; ++i)
+        {
+            if(i > 0)
+                append(expr, operators[pick(3)]);
+            if(pick(4) == 0)
+                append(expr, "-");
+            append(expr, std::to_string(pick(1000)));
+        }
+
+        return expr;
+    }
+
+private:
+    unsigned pick(unsigned n)
+    {
+        return static_cast<unsigned>(random() % n);
+    }
+
+    static void append(CheckedExpression& expr, const std::string& token)
+    {
+        expr.compact += token;
+        if(!expr.spaced.empty())
+            expr.spaced += ' ';
+        expr.spaced += token;
+    }
+
+    void appendOperand(CheckedExpression& expr)
+    {
+        static const char* const unary[] = { "-", "+", "~" };
+
+        for(unsigned nbUnary = (pick(3) == 0 ? 1 + pick(2) : 0); nbUnary > 0; --nbUnary)
+            append(expr, unary[pick(3)]);
+
+        // Small values, then values of any size (the large ones are unsigned)
+        std::uint64_t value = random();
+        switch(pick(4))
+        {
+            case 0: value %= 16; break;
+            case 1: value %= 100000; break;
+            case 2: value >>= pick(64); break;
+            default: break;
+        }
+
+        std::ostringstream literal;
+        switch(pick(3))
+        {
+            case 0: literal << value; break;
+            case 1: literal << "0x" << std::hex << value; break;
+            default: literal << '0' << std::oct << value; break;
+        }
+
+        if(pick(5) == 0)
+            literal << 'U';
+        else if(pick(5) == 0)
+            literal << "UL";
+
+        append(expr, literal.str());
+    }
+
+    std::mt19937_64 random;
+};
+
+/** \brief compute an expression with the kernel.
+ */
+static bool evaluateWithKernel(const std::string& expr, IntegerValue& value)
+{
+    return evaluateIntegerExpression(expr.data(), expr.size(), value);
+}
+
+/** \brief compare the kernel with the compiler: each value is checked by #if directives, "#error" is reached on a difference.
+ *
+ * \return the number of differences, -1 if the compiler could not be run.
+ */
+static long checkWithCompiler(const std::string& compiler, unsigned count, ExpressionGenerator& generator, unsigned& nbChecked)
+{
+    const std::string sourcePath = "arithmeticcheck_if.c";
+    const std::string errorPath = "arithmeticcheck_if.log";
+
+    std::ofstream source(sourcePath);
+    if(!source)
+        return -1;
+
+    nbChecked = 0;
+    for(unsigned i=0; i<count; ++i)
+    {
+        const CheckedExpression expr = generator.makeExpression();
+        IntegerValue value;
+
+        // The values that are not computable (division by zero..) are errors for the compiler too
+        if(!evaluateWithKernel(expr.compact, value))
+            continue;
+
+        source << "#if ((" << expr.spaced << ") + 0U) != 0x" << std::hex << value.bits << std::dec << "U\n";
+        source << "#error arithmeticcheck: value of " << expr.compact << '\n';
+        source << "#endif\n";
+        source << "#if (((" << expr.spaced << ") - (" << expr.spaced << ") - 1) < 0) != " << (value.isUnsigned ? 0 : 1) << '\n';
+        source << "#error arithmeticcheck: signedness of " << expr.compact << '\n';
+        source << "#endif\n";
+        ++nbChecked;
+    }
+    source.close();
+
+    const int status = std::system((compiler + ' ' + sourcePath + " > /dev/null 2> " + errorPath).c_str());
+
+    std::ifstream errors(errorPath);
+    std::string line;
+    long nbDifferences = 0;
+
+    while(std::getline(errors, line))
+    {
+        if(line.find("arithmeticcheck:") != std::string::npos){
+            std::cerr << line << std::endl;
+            ++nbDifferences;
+        }
+    }
+
+    if(status != 0 && nbDifferences == 0)
+        return -1;
+
+    std::remove(sourcePath.c_str());
+    std::remove(errorPath.c_str());
+    return nbDifferences;
+}
+
+/** \brief compare the kernel with the legacy evaluator, on the expressions the legacy evaluator computes exactly.
+ *
+ * \return the number of differences.
+ */
+static unsigned long checkWithLegacy(unsigned count, ExpressionGenerator& generator)
+{
+    unsigned long nbDifferences = 0;
+
+    for(unsigned i=0; i<count; ++i)
+    {
+        const CheckedExpression expr = generator.makeLegacyExpression();
+        IntegerValue value;
+
+        double legacy;
+        try {
+            legacy = evaluateSimpleArithmeticExpr(expr.compact);
+        }
+        catch(const std::exception&){
+            legacy = 0.5;
+        }
+
+        if(!evaluateWithKernel(expr.compact, value) || value.isUnsigned || static_cast<double>(value.asSigned()) != legacy)
+        {
+            std::cerr << "Different from the legacy evaluator: " << expr.compact << " gives " << integerToString(value) << " instead of " << legacy << std::endl;
+            ++nbDifferences;
+        }
+    }
+
+    return nbDifferences;
+}
+
+/** \brief time the kernel and the legacy evaluator on a few expressions.
+ */
+static void runBenchmark()
+{
+    static const char* const expressions[] = { "2*3+4*5-6/2", "123456789%1000", "1073741824+1024*3", "-5*7+100000-3*3*3" };
+
+    for(const char* expr: expressions)
+    {
+        const std::string str = expr;
+        volatile std::uint64_t sink = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for(unsigned i=0; i<CHECK_BENCHMARK_ITERATIONS; ++i){
+            IntegerValue value;
+            if(evaluateWithKernel(str, value))
+                sink = sink + value.bits;
+        }
+        const double kernelTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count();
+
+        // The legacy evaluator is much slower, it is timed on fewer iterations
+        const unsigned legacyIterations = CHECK_BENCHMARK_ITERATIONS/100;
+        start = std::chrono::steady_clock::now();
+        for(unsigned i=0; i<legacyIterations; ++i)
+            sink = sink + static_cast<std::uint64_t>(evaluateSimpleArithmeticExpr(str));
+        const double legacyTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count();
+
+        std::cout << expr << ": " << kernelTime/CHECK_BENCHMARK_ITERATIONS << " ns (kernel), "
+                  << legacyTime/legacyIterations << " ns (legacy)." << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned count = 100000;
+    unsigned long long seed = 1;
+    std::string compiler = "cc -E -P -w";
+
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if(arg == "--count" && i+1 < argc)
+            count = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--seed" && i+1 < argc)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--compiler" && i+1 < argc)
+            compiler = argv[++i];
+        else {
+            std::cerr << "usage: ArithmeticCheck [--count n] [--seed s] [--compiler \"cc -E -P -w\"]" << std::endl;
+            return 1;
+        }
+    }
+
+    ExpressionGenerator generator(seed);
+    bool correct = true;
+
+    unsigned nbChecked = 0;
+    const long compilerDifferences = checkWithCompiler(compiler, count, generator, nbChecked);
+    if(compilerDifferences < 0){
+        std::cerr << "Error: the compiler '" << compiler << "' could not be run." << std::endl;
+        correct = false;
+    }
+    else {
+        std::cout << nbChecked << " expressions compared with the compiler: " << compilerDifferences << " differences." << std::endl;
+        correct = correct && (compilerDifferences == 0);
+    }
+
+    const unsigned long legacyDifferences = checkWithLegacy(count, generator);
+    std::cout << count << " expressions compared with the legacy evaluator: " << legacyDifferences << " differences." << std::endl;
+    correct = correct && (legacyDifferences == 0);
+
+    runBenchmark();
+
+    return (correct ? 0 : 1);
+}
@@ -0,0 +1,413 @@
+/**
+  ******************************************************************************
+  * @file    batch.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+#include <cstdio>
+#include <cctype>
+
+#include "batch.hpp"
+#include "stringeval.hpp"
+#include "literals.hpp"
+#include "strings.hpp"
+#include "arithmetic.hpp"
+
+/**< the result of the evaluation of a macro. */
+struct BatchRow
+{
+    std::string value;
+    std::string hexa;
+    std::string status;
+};
+
+bool readBatchFormat(const std::string& str, BatchFormat& format)
+{
+    std::string name = str;
+    lowerString(name);
+
+    if(name == "csv")
+        format = BatchFormat::CSV;
+    else if(name == "json")
+        format = BatchFormat::JSON;
+    else
+        return false;
+
+    return true;
+}
+
+bool matchesGlob(const std::string& pattern, const std::string& name)
+{
+    std::size_t p = 0, n = 0;
+
+    // The position after the last '*' met, and the position of the name it currently stands for
+    std::size_t starPattern = std::string::npos, starName = 0;
+
+    while(n < name.size())
+    {
+        if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])){
+            ++p;
+            ++n;
+        }
+        else if(p < pattern.size() && pattern[p] == '*'){
+            starPattern = ++p;
+            starName = n;
+        }
+        else if(starPattern != std::string::npos){
+            // The last '*' takes one more character
+            p = starPattern;
+            n = ++starName;
+        }
+        else
+            return false;
+    }
+
+    while(p < pattern.size() && pattern[p] == '*')
+        ++p;
+
+    return p == pattern.size();
+}
+
+/** \brief read the names and patterns listed in a file.
+ *
+ * \return false if the file could not be opened.
+ */
+static bool readListFile(const std::string& filepath, std::vector<std::string>& patterns)
+{
+    std::ifstream file(filepath);
+    if(!file)
+        return false;
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        std::size_t comment = line.find("//");
+        if(comment != std::string::npos)
+            line.erase(comment);
+
+        const std::size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos)
+            continue;
+
+        const std::size_t last = line.find_last_not_of(" \t\r");
+        patterns.emplace_back(line, first, last-first+1);
+    }
+
+    return true;
+}
+
+/** \brief list the macros designated by names and patterns, the ones already listed are skipped.
+ *
+ * \param readFiles false if the "@file" parameters must be ignored (inside a file, it prevents any infinite recursion).
+ * \return false if a file could not be opened.
+ */
+static bool expandPatterns(const MacroContainer& macroContainer, const std::vector<std::string>& patterns, bool readFiles,
+                           std::vector<std::string>& names, std::unordered_set<std::string>& listed, std::string& missingFile)
+{
+    bool everyFileRead = true;
+
+    for(const std::string& pattern: patterns)
+    {
+        if(pattern.empty())
+            continue;
+
+        if(pattern.front() == '=')
+        {
+            if(pattern.size() > 1 && listed.insert(pattern.substr(1)).second)
+                names.push_back(pattern.substr(1));
+            continue;
+        }
+        else if(pattern.front() == '@')
+        {
+            std::vector<std::string> fromFile;
+
+            if(!readFiles)
+                continue;
+            else if(!readListFile(pattern.substr(1), fromFile)){
+                if(everyFileRead)
+                    missingFile = pattern.substr(1);
+                everyFileRead = false;
+            }
+            else
+                expandPatterns(macroContainer, fromFile, false, names, listed, missingFile);
+
+            continue;
+        }
+
+        const std::size_t wildcard = pattern.find_first_of("*?");
+        if(wildcard == std::string::npos)
+        {
+            if(listed.insert(pattern).second)
+                names.push_back(pattern);
+            continue;
+        }
+
+        // Only the names starting like the pattern have to be checked
+        std::vector<const std::string*> objectLike, functionLike;
+        macroContainer.listNamesStartingWith(pattern.substr(0, wildcard), objectLike, functionLike);
+
+        std::vector<const std::string*> matching;
+        for(const std::string* name: objectLike){
+            if(matchesGlob(pattern, *name))
+                matching.push_back(name);
+        }
+
+        // The names of the parents come after the others, let's sort all of them
+        std::sort(matching.begin(), matching.end(), [](const std::string* a, const std::string* b){ return *a < *b; });
+
+        for(const std::string* name: matching){
+            if(listed.insert(*name).second)
+                names.push_back(*name);
+        }
+    }
+
+    return everyFileRead;
+}
+
+bool expandBatchNames(const MacroContainer& macroContainer, const std::vector<std::string>& patterns,
+                      std::vector<std::string>& names, std::string& missingFile)
+{
+    std::unordered_set<std::string> listed(names.begin(), names.end());
+    return expandPatterns(macroContainer, patterns, true, names, listed, missingFile);
+}
+
+/** \brief write an integer value in hexadecimal, whatever its size (unlike tryConvertToHexa()).
+ *         The negative values are given as their two's complement on 64 bits.
+ *
+ * \return false if the value is not an integer.
+ */
+static bool toHexa(const std::string& value, std::string& hexa)
+{
+    const bool negative = (!value.empty() && value.front() == '-');
+
+    IntegerValue integer;
+    if(!readIntegerLiteral(value.data()+negative, value.size()-negative, integer))
+        return false;
+
+    if(negative)
+        negateInteger(integer);
+
+    hexa = (integer.bits == 0 ? "0x0" : "0x" + convertDeciToHexa(integer.bits));
+    return true;
+}
+
+/** \brief check if an expression is made of a single identifier.
+ */
+static bool isIdentifier(const std::string& str)
+{
+    if(str.empty() || isdigit(static_cast<unsigned char>(str.front())))
+        return false;
+
+    for(char c: str){
+        if(!isMacroCharacter(c))
+            return false;
+    }
+
+    return true;
+}
+
+/** \brief get the status of a value given by the evaluator: the evaluator reports an undefined macro met inside
+ *         the expansion as a successful result such as "undefined:(10+UNDEF)", and an uncertain result ends with '?'.
+ */
+static std::string statusOfValue(const std::string& value)
+{
+    if(value.find("unknown:") != std::string::npos || value.find("undefined:") != std::string::npos)
+        return "error";
+
+    if(!value.empty() && value.back() == '?')
+        return "warning";
+
+    return "ok";
+}
+
+/** \brief evaluate a macro or an expression, the way the command 'evaluate' does.
+ */
+static void evaluateRow(const MacroContainer& macroContainer, const std::string& name, const Options& config, BatchRow& row)
+{
+    if(isIdentifier(name) && !macroContainer.exists(name)){
+        row.status = "undefined";
+        return;
+    }
+
+    std::string expr = name;
+    std::vector<std::string> results;
+    const CalculationStatus status = calculateExpression(expr, macroContainer, config, nullptr, true, &results);
+
+    std::sort(results.begin(), results.end());
+    results.erase(std::unique(results.begin(), results.end()), results.end());
+
+    // The macro has several possible values, they are all given
+    if(results.size() > 1)
+    {
+        row.status = "multiple";
+
+        bool everyHexa = true;
+        for(std::size_t i=0; i<results.size(); ++i)
+        {
+            // A single value that could not be computed makes the whole row fail
+            const std::string status = statusOfValue(results[i]);
+            if(status == "error" || (status == "warning" && row.status == "multiple"))
+                row.status = status;
+
+            std::string hexa;
+            everyHexa = everyHexa && toHexa(results[i], hexa);
+
+            if(i > 0){
+                row.value += " | ";
+                row.hexa += " | ";
+            }
+            row.value += results[i];
+            row.hexa += hexa;
+        }
+
+        if(!everyHexa)
+            row.hexa.clear();
+        return;
+    }
+
+    if(expr.empty() && !results.empty())
+        expr = results.front();
+
+    row.value = expr;
+
+    if(status == CalculationStatus::EVAL_ERROR){
+        row.status = "error";
+        return;
+    }
+
+    row.status = statusOfValue(expr);
+
+    if(row.status == "ok" && status == CalculationStatus::EVAL_WARNING)
+        row.status = "warning";
+
+    toHexa(expr, row.hexa);
+}
+
+/** \brief write a field of a CSV row, it is quoted only when needed.
+ */
+static void writeCsvField(std::ostream& output, const std::string& field)
+{
+    if(field.find_first_of(",\"\r\n") == std::string::npos && (field.empty() || (field.front() != ' ' && field.back() != ' '))){
+        output << field;
+        return;
+    }
+
+    output << '"';
+    for(char c: field){
+        if(c == '"')
+            output << '"';
+        output << c;
+    }
+    output << '"';
+}
+
+void writeJsonString(std::ostream& output, const std::string& str)
+{
+    output << '"';
+    for(char c: str)
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+
+        if(c == '"' || c == '\\')
+            output << '\\' << c;
+        else if(c == '\n')
+            output << "\\n";
+        else if(c == '\r')
+            output << "\\r";
+        else if(c == '\t')
+            output << "\\t";
+        else if(u < 0x20 || u >= 0x7F)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", u);
+            output << escaped;
+        }
+        else
+            output << c;
+    }
+    output << '"';
+}
+
+std::size_t evaluateBatch(const MacroContainer& macroContainer, const std::vector<std::string>& names,
+                          const Options& config, BatchFormat format, std::ostream& output)
+{
+    // Keys starting with a line break can't be confused with the expressions cached by calculateExprWithStrOutput()
+    const bool useCache = !config.doesPrintReplacements() && !config.doesPrintExprAtEveryStep();
+    const std::string cachePrefix = "\nbatch\n";
+
+    std::size_t nbFailed = 0;
+
+    if(format == BatchFormat::CSV)
+        output << "name,value,hexa,status\n";
+    else
+        output << "[";
+
+    for(std::size_t i=0; i<names.size(); ++i)
+    {
+        const std::string& name = names[i];
+        BatchRow row;
+        std::string cached;
+
+        if(useCache && macroContainer.getEvaluationCache().find(cachePrefix+name, cached))
+        {
+            // The row is stored as "status\nvalue\nhexa", none of them contain a line break
+            const std::size_t first = cached.find('\n');
+            const std::size_t second = cached.find('\n', first+1);
+            row.status = cached.substr(0, first);
+            row.value = cached.substr(first+1, second-first-1);
+            row.hexa = cached.substr(second+1);
+        }
+        else
+        {
+            evaluateRow(macroContainer, name, config, row);
+
+            if(useCache && row.value.find('\n') == std::string::npos)
+                macroContainer.getEvaluationCache().store(cachePrefix+name, row.status+'\n'+row.value+'\n'+row.hexa);
+        }
+
+        if(row.status == "error" || row.status == "undefined")
+            ++nbFailed;
+
+        if(format == BatchFormat::CSV)
+        {
+            writeCsvField(output, name);
+            output << ',';
+            writeCsvField(output, row.value);
+            output << ',';
+            writeCsvField(output, row.hexa);
+            output << ',' << row.status << '\n';
+        }
+        else
+        {
+            output << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+            writeJsonString(output, name);
+            output << ",\"value\":";
+            writeJsonString(output, row.value);
+            output << ",\"hexa\":";
+            writeJsonString(output, row.hexa);
+            output << ",\"status\":\"" << row.status << "\"}";
+        }
+    }
+
+    if(format == BatchFormat::JSON)
+        output << "\n]\n";
+
+    output.flush();
+    return nbFailed;
+}
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    batch.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+/// This file describes the evaluation of a list of macros in a single run, with an output made to be read by other programs.
+/// Each macro (or expression) gives one row: its name, its value, its hexadecimal value and a status (ok, warning, multiple, error, undefined).
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "container.hpp"
+#include "options.hpp"
+
+/**< the machine-readable formats of the rows. */
+enum class BatchFormat { CSV, JSON };
+
+/** \brief read the name of a format ("csv" or "json", the case does not matter).
+ *
+ * \param str the name of the format.
+ * \param format the format read.
+ * \return false if the format is unknown.
+ */
+bool readBatchFormat(const std::string& str, BatchFormat& format);
+
+/** \brief check if a macro name matches a glob pattern ('*' matches any sequence of characters, '?' matches one character).
+ */
+bool matchesGlob(const std::string& pattern, const std::string& name);
+
+/** \brief list the macros designated by a list of names and patterns, each macro is listed once, in the order it is designated.
+ *         - a name without wildcard is listed even if it is not defined.
+ *         - a glob pattern lists the macros without parameters matching it, sorted by name.
+ *         - "@file" reads the names and patterns from a file (one per line, the empty lines and // comments are ignored).
+ *         - "=expr" designates an expression, evaluated as it is (the '*' are multiplications, not wildcards).
+ *
+ * \param macroContainer the database of macros.
+ * \param patterns the names, patterns and files given by the user.
+ * \param names the names of the macros to be evaluated.
+ * \param missingFile the first file that could not be opened.
+ * \return false if a file could not be opened.
+ */
+bool expandBatchNames(const MacroContainer& macroContainer, const std::vector<std::string>& patterns,
+                      std::vector<std::string>& names, std::string& missingFile);
+
+/** \brief write a string in JSON (quoted and escaped), the bytes outside ASCII are read as latin-1 characters like the source files.
+ */
+void writeJsonString(std::ostream& output, const std::string& str);
+
+/** \brief evaluate a list of macros (or expressions) and write one row per macro.
+ *         The results are kept in the evaluation cache of the database, so the macros are evaluated once until the database changes.
+ *
+ * \param macroContainer the database of macros.
+ * \param names the names of the macros to be evaluated.
+ * \param config the options used for string evaluation.
+ * \param format the format of the rows.
+ * \param output the stream receiving the rows.
+ * \return the number of macros that could not be evaluated (error or undefined).
+ */
+std::size_t evaluateBatch(const MacroContainer& macroContainer, const std::vector<std::string>& names,
+                          const Options& config, BatchFormat format, std::ostream& output);
+
+#endif // BATCH_HPP
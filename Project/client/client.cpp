@@ -0,0 +1,272 @@
+/**
+  ******************************************************************************
+  * @file    client.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/// A small client of the evaluation server (MacroParser --serve socket), see server.hpp for the protocol.
+/// It is a program of its own: g++ -std=c++11 client.cpp -o MacroParserClient
+/// It sends requests and prints the responses (one JSON object per line) on the standard output.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#if !(defined(_WIN32) || defined(_WIN64))
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#endif
+
+/**< the exit codes, the same as the command line mode of MacroParser. */
+enum ClientExitCode { EXIT_ALL_EVALUATED = 0, EXIT_INCORRECT_CALL = 1, EXIT_EVALUATION_FAILED = 2 };
+
+static void printUsage()
+{
+    std::cerr << "usage: MacroParserClient socket [command] [--space macrospace] [arguments..]\n";
+    std::cerr << "- MacroParserClient socket : send the requests read from the standard input (one JSON object per line)\n";
+    std::cerr << "- MacroParserClient socket look [--space macrospace] [macro/pattern/@file..] : evaluate macros\n";
+    std::cerr << "- MacroParserClient socket evaluate [--space macrospace] [expr] : evaluate an expression\n";
+    std::cerr << "- MacroParserClient socket shutdown : stop the server\n";
+    std::cerr << "- MacroParserClient socket [command] [arguments..] : run any other command (importfolder, define, spacediff..)\n";
+    std::cerr << "Exit codes: 0 = success, 1 = incorrect call or request refused, 2 = at least one value could not be computed." << std::endl;
+}
+
+/** \brief write a string in JSON (quoted and escaped).
+ */
+static void appendJsonString(std::string& output, const std::string& str)
+{
+    output += '"';
+    for(char c: str)
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+
+        if(c == '"' || c == '\\'){
+            output += '\\';
+            output += c;
+        }
+        else if(c == '\n')
+            output += "\\n";
+        else if(c == '\t')
+            output += "\\t";
+        else if(u < 0x20 || u >= 0x7F){
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", u);
+            output += escaped;
+        }
+        else
+            output += c;
+    }
+    output += '"';
+}
+
+/** \brief build the request described by the arguments of the command line.
+ */
+static std::string makeRequest(int argc, char* argv[])
+{
+    const std::string command = argv[2];
+    std::string space;
+    std::vector<std::string> arguments;
+
+    for(int i=3; i<argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if(arg == "--space" && i+1 < argc && (command == "look" || command == "evaluate"))
+            space = argv[++i];
+        else
+            arguments.push_back(arg);
+    }
+
+    std::string request = "{\"id\":1,\"command\":";
+    appendJsonString(request, command);
+
+    if(!space.empty()){
+        request += ",\"space\":";
+        appendJsonString(request, space);
+    }
+
+    if(command == "look")
+    {
+        request += ",\"macros\":[";
+        for(std::size_t i=0; i<arguments.size(); ++i)
+        {
+            std::string macro = arguments[i];
+
+#if !(defined(_WIN32) || defined(_WIN64))
+            // The server may run from another directory
+            char absolute[PATH_MAX];
+            if(macro.size() > 1 && macro.front() == '@' && realpath(macro.c_str()+1, absolute))
+                macro = std::string("@") + absolute;
+#endif
+
+            if(i > 0)
+                request += ',';
+            appendJsonString(request, macro);
+        }
+        request += ']';
+    }
+    else
+    {
+        std::string joined;
+        for(const std::string& arg: arguments){
+            if(!joined.empty())
+                joined += ' ';
+            joined += arg;
+        }
+
+        request += (command == "evaluate" ? ",\"expr\":" : ",\"args\":");
+        appendJsonString(request, joined);
+    }
+
+    request += '}';
+    return request;
+}
+
+/** \brief get the exit code corresponding to a response.
+ */
+static int exitCodeOf(const std::string& response)
+{
+    if(response.find("\"ok\":true") == std::string::npos)
+        return EXIT_INCORRECT_CALL;
+
+    const std::size_t failed = response.find("\"failed\":");
+    if(failed != std::string::npos && response.compare(failed+9, 2, "0,") != 0)
+        return EXIT_EVALUATION_FAILED;
+
+    return EXIT_ALL_EVALUATED;
+}
+
+#if !(defined(_WIN32) || defined(_WIN64))
+
+/** \brief send a request and read its response.
+ *
+ * \return false if the server disconnected.
+ */
+static bool exchange(int server, const std::string& request, std::string& pending, std::string& response)
+{
+    const std::string line = request + '\n';
+    std::size_t sent = 0;
+
+    while(sent < line.size())
+    {
+        const ssize_t written = send(server, line.data()+sent, line.size()-sent, 0);
+        if(written < 0 && errno == EINTR)
+            continue;
+        if(written <= 0)
+            return false;
+        sent += static_cast<std::size_t>(written);
+    }
+
+    std::size_t end;
+    while((end = pending.find('\n')) == std::string::npos)
+    {
+        char buffer[65536];
+        const ssize_t received = recv(server, buffer, sizeof(buffer), 0);
+        if(received < 0 && errno == EINTR)
+            continue;
+        if(received <= 0)
+            return false;
+        pending.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    response = pending.substr(0, end);
+    pending.erase(0, end+1);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2 || std::string(argv[1]) == "--help"){
+        printUsage();
+        return (argc < 2 ? EXIT_INCORRECT_CALL : EXIT_ALL_EVALUATED);
+    }
+
+    const std::string socketPath = argv[1];
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if(socketPath.size() >= sizeof(address.sun_path)){
+        std::cerr << "Error: the socket path '" << socketPath << "' is too long." << std::endl;
+        return EXIT_INCORRECT_CALL;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size()+1);
+
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0 || connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0){
+        std::cerr << "Error: can't connect to '" << socketPath << "' (" << std::strerror(errno) << ")." << std::endl;
+        return EXIT_INCORRECT_CALL;
+    }
+
+    std::vector<std::string> requests;
+
+    if(argc >= 3)
+        requests.push_back(makeRequest(argc, argv));
+
+    int exitCode = EXIT_ALL_EVALUATED;
+    std::string pending, response, line;
+    bool fromInput = requests.empty();
+
+    // The requests of the standard input are sent one after the other, as they are read
+    while(fromInput ? static_cast<bool>(std::getline(std::cin, line)) : !requests.empty())
+    {
+        if(!fromInput){
+            line = requests.back();
+            requests.pop_back();
+        }
+
+        if(line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        if(!exchange(server, line, pending, response)){
+            std::cerr << "Error: the server disconnected." << std::endl;
+            close(server);
+            return EXIT_INCORRECT_CALL;
+        }
+
+        std::cout << response << std::endl;
+
+        const int code = exitCodeOf(response);
+        if(code > exitCode)
+            exitCode = code;
+    }
+
+    close(server);
+    return exitCode;
+}
+
+#else
+
+int main(int argc, char* argv[])
+{
+    (void) argc;
+    (void) argv;
+    (void) makeRequest;
+    (void) exitCodeOf;
+    printUsage();
+    std::cerr << "Error: the server needs Unix domain sockets, it can't be used on this platform." << std::endl;
+    return EXIT_INCORRECT_CALL;
+}
+
+#endif
@@ -33,21 +33,35 @@
 #include "closestr.hpp"
 #include "macrosearch.hpp"
 #include "calculate.hpp"
+#include "snapshot.hpp"
+#include "macrograph.hpp"
+#include "tokeneval.hpp"
 
 
 using std::cout;
 using std::endl;
 
-static auto* gg = std::cout.rdbuf();
-
 
 CommandManager::CommandManager()
-: configuration(), macrospaces()
-{}
+: configuration(), macrospaces(), interactive(true)
+{
+    // The commands use it as soon as they run
+    macrospaces.getMacroSpace("default");
+}
 
 CommandManager::CommandManager(const Options& options)
-: configuration(options), macrospaces()
-{}
+: configuration(options), macrospaces(), interactive(true)
+{
+    macrospaces.getMacroSpace("default");
+}
+
+bool CommandManager::askUser(std::string& answer)
+{
+    if(!interactive)
+        return false;
+
+    return static_cast<bool>(std::getline(std::cin, answer));
+}
 
 
 static void printBasicHelp()
@@ -79,9 +93,15 @@ static void printAdvancedHelp()
 
     cout << "\nADVANCED COMMANDS (other useful commands):" << endl;
     cout << "- define [macro] [value] : add/replace a specific macro by a specific value" << endl;
+    cout << "- derive [parent] [macrospace] : create a macrospace storing only its differences with the parent macrospace" << endl;
     cout << "- interpret [macro] : look and choose among possible definitions for a macro" << endl;
     cout << "- interpretall [macro] : interpret all macros involved in [macro] evaluation" << endl;
     cout << "- evaluate [expr] : evaluate an expression that may contain macros, boolean values.." << endl;
+    cout << "- batch [macro/pattern/@file..] [macrospace?] [--json?] [--output file?] : evaluate macros (glob patterns like GPIO*_BASE accepted) and write CSV/JSON rows with their value, hexa value and status" << endl;
+    cout << "- evaluateall [macrospace?] : evaluate every macro without parameters, each one after the macros it depends on" << endl;
+    cout << "- deps [macro] [macrospace?] : list the macros a macro refers to" << endl;
+    cout << "- rdeps [macro] [macrospace?] : list the macros referring to a macro" << endl;
+    cout << "- graph [macrospace?] : print the circular definitions and the identifiers that are not defined" << endl;
     cout << "- options : display the options used for file import and string evaluation" << endl;
     cout << "- changeoption [name] [value] : change the parameter given to an option" << endl;
     cout << "- clear [all/ok/re/in] : empty the list of all/okay/redefined/incorrect macros" << endl;
@@ -91,6 +111,8 @@ static void printAdvancedHelp()
     cout << "[command] [macrospace?]: to run the command in a macrospace, add macrospace at the end" << endl;
     cout << "- printsources [macrospace] : list the folders from which the list origins" << endl;
     cout << "- list spaces : list the macrospaces currently defined" << endl;
+    cout << "- save [macrospace] [file] : save all macros of a macrospace into a snapshot file" << endl;
+    cout << "- load [file] [macrospace?] : reload a snapshot file, in the macrospace it was saved from by default" << endl;
     cout << "- spacediff [macrospace1] [macrospace2..] [--different?] [--notunknown?] [--notundefined?] [--alpha?] [--increasing?] [--decreasing?]: compare values of macros between macrospaces." << endl;
     cout << "spacediff options: different=keep only macros with different values, notunknown/notundefined: don't show macros with unknown/undefined macro values, increasing/decreasing: sort the macros by macro values in increasing/decreasing order" << std::endl;
     cout << "msall is a macrospace that designate all the macrospaces unified." << endl;
@@ -118,8 +140,10 @@ void CommandManager::dealWithUser()
     {
         cout << " > ";
 
+        // The input ended, nobody is left to type 'exit'
         string userInput;
-        getline(std::cin, userInput);
+        if(!getline(std::cin, userInput))
+            break;
 
         //const auto start = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
@@ -245,6 +269,9 @@ bool CommandManager::runCommand(const string& input)
             // Finally let's clear the macro database
             for(const std::string& str: commandMacrospaces)
                 macrospaces.getMacroSpace(str).clearDatabase(eraseOk, eraseRe, eraseIn);
+
+            // The names and the values of the macros erased are not needed anymore
+            macrospaces.releaseUnusedStrings(true);
         }
     }
     else if(isRoughlyEqualTo("interpretall",commandStr))
@@ -323,7 +350,11 @@ bool CommandManager::runCommand(const string& input)
                 }
 
                 std::cout << " >> ";
-                std::getline(std::cin, userInput);
+                if(!askUser(userInput))
+                {
+                    std::cout << "No definition can be chosen without a user, the interpretation stops here." << std::endl;
+                    break;
+                }
 
                 int numInput = -1;
 
@@ -339,6 +370,9 @@ bool CommandManager::runCommand(const string& input)
                 if(numInput >= 1 && numInput <= static_cast<int>(possibilities.size())){
                     mc->emplaceAndReplace(warnings.front(), possibilities[numInput-1]);
                 }
+                else if(numInput == 0){
+                    break;
+                }
                 else {
                     goto reask;
                 }
@@ -480,9 +514,9 @@ bool CommandManager::runCommand(const string& input)
                 std::cout << "0. Cancel, don't interpret this macro." << endl;
 
                 std::string ss;
-                getline(std::cin, ss);
-
-                if(isAllDigits(ss))
+                if(!askUser(ss))
+                    std::cout << "No definition can be chosen without a user, the macro was not interpreted." << endl;
+                else if(isAllDigits(ss))
                 {
                     int result = std::atoi(ss.c_str());
                     //cout << "result= " << result << endl;
@@ -528,7 +562,7 @@ bool CommandManager::runCommand(const string& input)
                 bool foundSomething=false;
 
                 //
-                for(auto& p : macrospaces.getMacroSpace(commandMacrospaces.front()).getDefines())
+                for(const auto& p : macrospaces.getMacroSpace(commandMacrospaces.front()).getDefines())
                 {
                     if(p.first == trueInputs.front())
                     {
@@ -689,6 +723,37 @@ bool CommandManager::runCommand(const string& input)
                 macroStringName = parameters[3];
             parameters.emplace_back();
             macrospaces.getMacroSpace(macroStringName).emplaceAndReplace(parameters[1], parameters[2]);
+
+            // The values replaced stay in the string pool until enough of them are there
+            macrospaces.releaseUnusedStrings(false);
+        }
+    }
+    else if(isRoughlyEqualTo("derive",commandStr))
+    {
+        if(parameters.size()!=3)
+        {
+            std::cout << "Error: please type 'derive [parent] [macrospace]'." << std::endl;
+        }
+        else if(!macrospaces.doesMacrospaceExists(parameters[1]))
+        {
+            std::cout << "The macrospace '" << parameters[1] << "' does not exist." << std::endl;
+        }
+        else if(macrospaces.doesMacrospaceExists(parameters[2]))
+        {
+            std::cout << "Error: the macrospace '" << parameters[2] << "' already exists." << std::endl;
+        }
+        else if(parameters[1] == "msall" || parameters[2] == "msall")
+        {
+            std::cout << "Error: msall is built from the other macrospaces, it can't be derived." << std::endl;
+        }
+        else if(!MacroContainer::isNameValid(parameters[2]))
+        {
+            std::cout << "Error: the name of a macrospace can only contain letters, digits and '_'." << std::endl;
+        }
+        else
+        {
+            macrospaces.deriveMacroSpace(parameters[1], parameters[2]);
+            std::cout << "The macrospace '" << parameters[2] << "' was derived from '" << parameters[1] << "'." << std::endl;
         }
     }
     else if(isRoughlyEqualTo("stat",commandStr))
@@ -789,6 +854,7 @@ bool CommandManager::runCommand(const string& input)
             {
                 if(curMacroSpace.importFromFolder(parameters.front(), configuration)){
                     printStatMacrospace(curMacroSpace);
+                    macrospaces.releaseUnusedStrings(false);
                 }
                 else
                     std::cout << "/!\\ Error: Can't open this directory /!\\" << endl;
@@ -855,6 +921,9 @@ bool CommandManager::runCommand(const string& input)
             }
             else {
                 printStatMacrospace(curMacroSpace);
+
+                // The macros of the files that changed since the last import were replaced
+                macrospaces.releaseUnusedStrings(false);
             }
         }
         else {
@@ -940,6 +1009,158 @@ bool CommandManager::runCommand(const string& input)
                 std::cout << total << " results found." << std::endl;
         }
     }
+    // deps must come before rdeps, and evaluateall before evaluate, otherwise they would be caught by the other one
+    else if(isRoughlyEqualTo("deps",commandStr) || isRoughlyEqualTo("rdeps",commandStr))
+    {
+        const bool reverse = isRoughlyEqualTo("rdeps",commandStr) && !isRoughlyEqualTo("deps",commandStr);
+
+        if(parameters.size()<2 || parameters.size()>3)
+        {
+            std::cout << "Error: please type '" << (reverse ? "rdeps" : "deps") << " [macro] [macrospace?]'." << std::endl;
+        }
+        else
+        {
+            MacroContainer *mc = &mcc;
+            if(parameters.size()==3)
+                mc = macrospaces.tryGetMacroSpace(parameters[2]);
+
+            std::size_t node;
+
+            if(!mc)
+                std::cout << "The macrospace '" << parameters[2] << "' does not exist." << std::endl;
+            else
+            {
+                MacroGraph graph(*mc);
+
+                if(!graph.find(parameters[1], node))
+                    std::cout << "The macro '" << parameters[1] << "' is not defined." << std::endl;
+                else
+                {
+                    const auto& linked = (reverse ? graph.getDependents(node) : graph.getDependencies(node));
+
+                    if(linked.empty())
+                        std::cout << (reverse ? "No macro refers to '" : "No macro is referred to by '") << graph.getName(node) << "'." << std::endl;
+                    else
+                    {
+                        std::cout << (reverse ? "Macros referring to '" : "Macros referred to by '") << graph.getName(node) << "':" << std::endl;
+                        for(std::size_t other: linked)
+                            std::cout << " - " << graph.getName(other) << std::endl;
+                    }
+
+                    if(!reverse && !graph.getUnresolved(node).empty())
+                    {
+                        std::cout << "Identifiers that are not defined:";
+                        for(const std::string& identifier: graph.getUnresolved(node))
+                            std::cout << ' ' << identifier;
+                        std::cout << std::endl;
+                    }
+
+                    if(graph.isCircular(node))
+                        std::cout << "/!\\ Warning: '" << graph.getName(node) << "' is part of a circular definition, or depends on one. /!\\" << std::endl;
+                }
+            }
+        }
+    }
+    else if(isRoughlyEqualTo("graph",commandStr))
+    {
+        MacroContainer *mc = &mcc;
+        if(parameters.size()>=2)
+            mc = macrospaces.tryGetMacroSpace(parameters[1]);
+
+        if(!mc)
+            std::cout << "The macrospace '" << parameters[1] << "' does not exist." << std::endl;
+        else
+        {
+            MacroGraph graph(*mc);
+            std::vector<std::string> unresolved;
+            graph.listUnresolved(unresolved);
+
+            std::cout << graph.size() << " macros refer " << graph.countReferences() << " times to each other." << std::endl;
+
+            std::cout << "|-> " << graph.getCycles().size() << " circular definitions";
+            std::cout << (graph.getCycles().empty() ? "." : ":") << std::endl;
+            for(const auto& cycle: graph.getCycles())
+            {
+                std::cout << " - ";
+                for(unsigned i=0; i<cycle.size(); ++i){
+                    if(i>0)
+                        std::cout << ", ";
+                    std::cout << graph.getName(cycle[i]);
+                }
+                std::cout << std::endl;
+            }
+
+            std::cout << "|-> " << unresolved.size() << " identifiers are not defined";
+            std::cout << (unresolved.empty() ? "." : ":") << std::endl;
+            for(unsigned i=0; i<unresolved.size() && i<5000; ++i)
+                std::cout << " - " << unresolved[i] << std::endl;
+            if(unresolved.size() > 5000)
+                std::cout << "Only printed the first 5000 results." << endl;
+        }
+    }
+    else if(isRoughlyEqualTo("evaluateall",commandStr))
+    {
+        MacroContainer *mc = &mcc;
+        if(parameters.size()>=2)
+            mc = macrospaces.tryGetMacroSpace(parameters[1]);
+
+        if(!mc)
+            std::cout << "The macrospace '" << parameters[1] << "' does not exist." << std::endl;
+        else
+        {
+            // Thanks to the topological order, each macro is evaluated after the macros it refers to:
+            // the integer values already computed are written (with their type) in its definition instead of expanding them again
+            MacroGraph graph(*mc);
+            const auto& dictionary = mc->getDefines();
+            const bool useTokens = !configuration.doesPrintReplacements() && !configuration.doesPrintExprAtEveryStep();
+            std::vector<std::string> values(graph.size());
+            unsigned nbEvaluated=0, nbCircular=0;
+
+            for(std::size_t node: graph.getTopologicalOrder())
+            {
+                const std::string& name = graph.getName(node);
+
+                if(name.back() == ')')
+                    continue;
+
+                if(graph.isCircular(node))
+                {
+                    std::cout << name << ": circular definition" << std::endl;
+                    ++nbCircular;
+                    continue;
+                }
+
+                // The macros defined several times are left to the evaluator, it gives all their possible values
+                std::string value;
+                IntegerValue integer;
+                bool evaluated = false;
+
+                auto range = dictionary.equal_range(name);
+                if(useTokens && dictionary.count(name) == 1 && range.first->second.find('#') == std::string::npos)
+                {
+                    value = graph.substituteValues(range.first->second, values);
+                    evaluated = evaluateTokens(value, *mc, nullptr, nullptr, &integer);
+                }
+
+                // The values that are not certain are reported the usual way
+                if(!evaluated){
+                    value = name;
+                    calculateExprWithStrOutput(value, *mc, configuration);
+                }
+                else if(value != "true" && value != "false"){
+                    // INTMAX_MIN can't be written as a literal
+                    if(integer.isUnsigned || integer.bits != (std::uint64_t(1) << 63))
+                        values[node] = integerToString(integer) + (integer.isUnsigned ? "U" : "");
+                    tryConvertToHexa(value);
+                }
+
+                std::cout << name << ": " << value << std::endl;
+                ++nbEvaluated;
+            }
+
+            std::cout << nbEvaluated << " macros were evaluated, " << nbCircular << " could not because of circular definitions." << std::endl;
+        }
+    }
     else if(isRoughlyEqualTo("evaluate",commandStr))
     {
         if(parameters.size() <= 1)
@@ -1086,6 +1307,51 @@ bool CommandManager::runCommand(const string& input)
 
         }
     }
+    else if(isRoughlyEqualTo("batch",commandStr))
+    {
+        // The parameters are read again, file paths must not be merged together
+        std::istringstream iss(input);
+        std::string word, macrospaceName, outputPath;
+        std::vector<std::string> patterns;
+        BatchFormat format = BatchFormat::CSV;
+        bool correct = true;
+
+        iss >> word;
+        while(iss >> word)
+        {
+            if(word == "--json")
+                format = BatchFormat::JSON;
+            else if(word == "--csv")
+                format = BatchFormat::CSV;
+            else if(word == "--output")
+                correct = correct && static_cast<bool>(iss >> outputPath);
+            else if(macrospaceName.empty() && macrospaces.doesMacrospaceExists(word))
+                macrospaceName = word;
+            else
+                patterns.push_back(word);
+        }
+
+        if(!correct || patterns.empty())
+        {
+            std::cout << "Error: Please enter the macros to evaluate, for instance: 'batch GPIO*_BASE --json --output values.json'." << std::endl;
+        }
+        else
+        {
+            if(macrospaceName.empty())
+                macrospaceName = "default";
+
+            std::ofstream file;
+            if(!outputPath.empty())
+                file.open(outputPath);
+
+            std::size_t nbFailed = 0;
+
+            if(!outputPath.empty() && !file)
+                std::cout << "Error: the file '" << outputPath << "' can't be written." << std::endl;
+            else if(runBatch(macrospaceName, patterns, format, outputPath.empty() ? std::cout : file, nbFailed) && !outputPath.empty())
+                std::cout << "The values were written to '" << outputPath << "', " << nbFailed << " macros could not be evaluated." << std::endl;
+        }
+    }
     else if(isRoughlyEqualTo("list",commandStr.substr(0,4)))
     {
         if(commandStr.substr(4).size()>=1)
@@ -1227,7 +1493,7 @@ bool CommandManager::runCommand(const string& input)
     else if(isRoughlyEqualTo("calculate", commandStr))
     {
         // Error: no parameters were entered.
-        if(parameters.empty())
+        if(parameters.size() <= 1)
         {
             std::cout << "Error: no parameters were entered." << std::endl;
             std::cout << "Please enter first the name of a macro, and potentially the name of a macrospace." << std::endl;
@@ -1241,38 +1507,24 @@ bool CommandManager::runCommand(const string& input)
 
             // 1. Let's ask the user for the file path in which the macro is contained.
             std::string filePath;
-            while(1)
-            {
-                std::cout << "Please enter a file in which you would like the macro to be calculated:" << std::endl;
-
-                std::getline(std::cin, filePath);
-
-                if(filePath.empty())
-                {
-                    std::cout << "Command aborted." << std::endl;
-                    break;
-                }
-
-                // Let's check if the
-            }
+            std::cout << "Please enter a file in which you would like the macro to be calculated:" << std::endl;
 
-            if(filePath.empty())
+            if(!askUser(filePath) || filePath.empty())
+            {
+                std::cout << "Command aborted." << std::endl;
                 return true;
+            }
 
             // 2. Let's ask the user for source directory.
             // (The directory in which will be contained all the source files).
             std::string sourceDirectoryPath;
-            while(1)
-            {
-                std::cout << "Please enter the source directory: " << std::endl;
+            std::cout << "Please enter the source directory: " << std::endl;
 
-                std::getline(std::cin, sourceDirectoryPath);
-
-                // Let's check that the directory exists.
-                if(directoryExists(sourceDirectoryPath.c_str()))
-                {
-
-                }
+            // Let's check that the directory exists.
+            if(!askUser(sourceDirectoryPath) || !directoryExists(sourceDirectoryPath.c_str()))
+            {
+                std::cout << "Command aborted: the source directory does not exist." << std::endl;
+                return true;
             }
 
             // the database of macros to be loaded.
@@ -1316,6 +1568,61 @@ bool CommandManager::runCommand(const string& input)
         else
             std::cout << "Error: no parameter given to the command." << std::endl;
     }
+    else if(isRoughlyEqualTo("save",commandStr))
+    {
+        if(parameters.size()!=3)
+        {
+            std::cout << "Error: please type 'save [macrospace] [file]'." << std::endl;
+        }
+        else if(!macrospaces.doesMacrospaceExists(parameters[1]))
+        {
+            std::cout << "The macrospace '" << parameters[1] << "' does not exist." << std::endl;
+        }
+        else if(Snapshot::save(parameters[2], parameters[1], macrospaces.getMacroSpace(parameters[1])))
+        {
+            std::cout << "The macrospace '" << parameters[1] << "' was saved to '" << parameters[2] << "'." << std::endl;
+        }
+        else
+        {
+            std::cout << "/!\\ Error: can't write the file '" << parameters[2] << "'. /!\\" << std::endl;
+        }
+    }
+    // load must come after loadscript, otherwise it would catch it
+    else if(isRoughlyEqualTo("load",commandStr))
+    {
+        std::string macrospaceName;
+
+        if(parameters.size()<2 || parameters.size()>3)
+        {
+            std::cout << "Error: please type 'load [file] [macrospace?]'." << std::endl;
+        }
+        else if(!Snapshot::readName(parameters[1], macrospaceName))
+        {
+            std::cout << "/!\\ Error: '" << parameters[1] << "' can't be opened or is not a snapshot file. /!\\" << std::endl;
+        }
+        else
+        {
+            if(parameters.size()==3)
+                macrospaceName = parameters[2];
+
+            if(macrospaceName == "msall")
+            {
+                std::cout << "Error: msall is built from the other macrospaces, please load the snapshot in another macrospace." << std::endl;
+            }
+            else
+            {
+                auto& curMacroSpace = macrospaces.getMacroSpace(macrospaceName);
+
+                if(Snapshot::load(parameters[1], curMacroSpace))
+                {
+                    std::cout << "Loaded in the macrospace '" << macrospaceName << "'." << std::endl;
+                    printStatMacrospace(curMacroSpace);
+                }
+                else
+                    std::cout << "/!\\ Error: the snapshot file '" << parameters[1] << "' is corrupted. /!\\" << std::endl;
+            }
+        }
+    }
     else if(isRoughlyEqualTo("exit",commandStr))
         return false;
     else {
@@ -1370,6 +1677,9 @@ bool CommandManager::loadScript(const std::string& filepath, bool printStatus)
 {
     std::ifstream file(filepath);
 
+    // The output may already be redirected, it is given back as it was
+    std::streambuf* previousOutput = std::cout.rdbuf();
+
     if(file)
     {
         if(printStatus)
@@ -1390,7 +1700,7 @@ bool CommandManager::loadScript(const std::string& filepath, bool printStatus)
                 }
                 else if(line == "TALKY")
                 {
-                    std::cout.rdbuf(gg);
+                    std::cout.rdbuf(previousOutput);
                 }
                 else if(!line.empty())
                 {
@@ -1402,7 +1712,7 @@ bool CommandManager::loadScript(const std::string& filepath, bool printStatus)
 
         }
 
-        std::cout.rdbuf(gg);
+        std::cout.rdbuf(previousOutput);
 
         if(printStatus)
             std::cout << "\nEnded the execution of " << filepath << '.' << std::endl;
@@ -1414,3 +1724,35 @@ bool CommandManager::loadScript(const std::string& filepath, bool printStatus)
     return false;
 }
 
+bool CommandManager::runBatch(const std::string& macrospaceName, const std::vector<std::string>& patterns,
+                              BatchFormat format, std::ostream& output, std::size_t& nbFailed)
+{
+    const MacroContainer* mc = macrospaces.tryGetMacroSpace(macrospaceName);
+    if(!mc)
+    {
+        std::cout << "The macrospace '" << macrospaceName << "' does not exist." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> names;
+    std::string missingFile;
+    if(!expandBatchNames(*mc, patterns, names, missingFile))
+    {
+        std::cout << "Error: the file '" << missingFile << "' can't be opened." << std::endl;
+        return false;
+    }
+
+    nbFailed = evaluateBatch(*mc, names, configuration, format, output);
+    return true;
+}
+
+const MacroContainer* CommandManager::findMacroSpace(const std::string& macrospaceName) const
+{
+    return macrospaces.findMacroSpace(macrospaceName);
+}
+
+void CommandManager::synchronizeMacroSpaces()
+{
+    // Looking for msall updates it
+    macrospaces.tryGetMacroSpace("msall");
+}
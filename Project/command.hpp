@@ -21,8 +21,11 @@
 #define COMMAND_HPP
 
 #include <string>
+#include <vector>
+#include <ostream>
 #include "macrospace.hpp"
 #include "options.hpp"
+#include "batch.hpp"
 
 /**< Our main program is here. This class interacts with the user using the console and is able to run string commands. */
 class CommandManager
@@ -59,11 +62,55 @@ public:
      */
     bool loadScript(const std::string& filepath, bool printStatus=false);
 
+    /** \brief evaluate a list of macros and write machine-readable rows (this is what the command 'batch' does).
+     *
+     * \param macrospaceName the macrospace in which the macros are evaluated.
+     * \param patterns the names, the glob patterns and the "@file" lists of macros.
+     * \param format the format of the rows.
+     * \param output the stream receiving the rows.
+     * \param nbFailed the number of macros that could not be evaluated.
+     *
+     * \return false if the macrospace or a list file does not exist (nothing is written).
+     */
+    bool runBatch(const std::string& macrospaceName, const std::vector<std::string>& patterns,
+                  BatchFormat format, std::ostream& output, std::size_t& nbFailed);
+
+    /** \brief choose if the commands may ask questions to the user (true by default).
+     *         Otherwise, the commands needing an answer are cancelled instead of waiting for one.
+     *
+     *  \param enabled false when no user is there to answer (command line mode).
+     */
+    inline void setInteractive(bool enabled) { interactive = enabled; }
+
+    /** \brief find a macrospace without changing anything, so that several threads can read it at the same time
+     *         (as long as no command is run meanwhile).
+     *
+     *  \return the macrospace, nullptr if it does not exist.
+     */
+    const MacroContainer* findMacroSpace(const std::string& macrospaceName) const;
+
+    /** \brief bring msall up to date with the other macrospaces, so that it can be read by findMacroSpace().
+     */
+    void synchronizeMacroSpaces();
+
+    // Getters
+    inline const Options& getConfiguration() const { return configuration; }
+
 private:
+    /** \brief read the answer of the user to a question asked by a command.
+     *
+     *  \param answer the line typed by the user.
+     *
+     *  \return false if there is no user to answer (non-interactive mode or end of the input).
+     */
+    bool askUser(std::string& answer);
+
     /**< contains a list of options easily modifiable by the end user. */
     Options configuration;
     /**< contains the macro database, with all the different macrospaces. */
     Macrospaces macrospaces;
+    /**< false if no user is there to answer questions. */
+    bool interactive;
 };
 
 #endif // COMMAND_HPP
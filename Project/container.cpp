@@ -20,35 +20,200 @@
 #include <iostream>
 #include <cassert>
 #include <algorithm>
+#include <iterator>
+#include <cstdlib>
+#include <cerrno>
 
 #include "container.hpp"
 #include "options.hpp"
 #include "vector.hpp"
 #include "stringeval.hpp"
+#include "threadpool.hpp"
+
+#define EVALUATION_CACHE_MAX_SIZE 1000000 /**< the cache is emptied when it contains more results than that. */
+
+/*** EvaluationCache ***/
+
+EvaluationCache::EvaluationCache()
+: mutex(), results(), revision(0)
+{}
+
+EvaluationCache::EvaluationCache(const EvaluationCache&)
+: mutex(), results(), revision(0)
+{}
+
+EvaluationCache& EvaluationCache::operator=(const EvaluationCache&)
+{
+    clear();
+    return *this;
+}
+
+bool EvaluationCache::find(const std::string& key, std::string& result) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = results.find(key);
+    if(it == results.end())
+        return false;
+
+    result = it->second;
+    return true;
+}
+
+void EvaluationCache::store(const std::string& key, const std::string& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(results.size() >= EVALUATION_CACHE_MAX_SIZE)
+        results.clear();
+
+    results[key] = result;
+}
+
+void EvaluationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // It is called for each macro added, clearing an empty table must cost nothing
+    if(!results.empty())
+        std::unordered_map< std::string, std::string >().swap(results);
+}
+
+void EvaluationCache::synchronize(unsigned long long currentRevision)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(revision != currentRevision)
+    {
+        std::unordered_map< std::string, std::string >().swap(results);
+        revision = currentRevision;
+    }
+}
+
+/*** DefinitionsView ***/
+
+DefinitionsView::const_iterator::const_iterator()
+: top(nullptr), layer(nullptr), entry(nullptr), current(nullptr)
+{}
+
+DefinitionsView::const_iterator::const_iterator(const MacroContainer* top)
+: top(top), layer(top), entry(top->defines.begin()), current(nullptr)
+{
+    skipOverridden();
+}
+
+void DefinitionsView::const_iterator::skipOverridden()
+{
+    while(layer)
+    {
+        // This layer is done, let's continue with its parent
+        if(entry == layer->defines.end())
+        {
+            layer = layer->parent;
+            if(layer)
+                entry = layer->defines.begin();
+        }
+        else if(layer != top && top->overrides(*entry->name(), layer))
+            ++entry;
+        else
+        {
+            current = entry->begin();
+            return;
+        }
+    }
+}
+
+DefinitionsView::const_iterator& DefinitionsView::const_iterator::operator++()
+{
+    // The values of a name are next to each other, the next name is only looked for after the last one
+    if(++current == entry->end())
+    {
+        ++entry;
+        skipOverridden();
+    }
+    return *this;
+}
+
+DefinitionsView::const_iterator DefinitionsView::const_iterator::operator++(int)
+{
+    const_iterator previous = *this;
+    ++(*this);
+    return previous;
+}
+
+DefinitionsView::const_iterator DefinitionsView::begin() const
+{
+    return const_iterator(container);
+}
+
+DefinitionsView::const_iterator DefinitionsView::end() const
+{
+    return const_iterator();
+}
+
+std::pair<DefinitionsView::value_iterator, DefinitionsView::value_iterator> DefinitionsView::equal_range(const std::string& macroName) const
+{
+    const MacroContainer* layer = container;
+
+    while(true)
+    {
+        const DefinitionTable::Entry* entry = layer->defines.find(macroName);
+
+        // The first layer defining the name hides the definitions of its parents
+        if(entry)
+            return std::make_pair(value_iterator(entry->name(), entry->begin()), value_iterator(entry->name(), entry->end()));
+
+        if(!layer->parent || layer->removedNames.count(macroName))
+            return std::make_pair(value_iterator(), value_iterator());
+
+        layer = layer->parent;
+    }
+}
+
+std::size_t DefinitionsView::count(const std::string& macroName) const
+{
+    auto range = equal_range(macroName);
+    return static_cast<std::size_t>(std::distance(range.first, range.second));
+}
+
+std::size_t DefinitionsView::size() const
+{
+    const MacroContainer* mc = container;
+    std::size_t total = mc->defines.size();
+
+    if(!mc->parent)
+        return total;
+
+    // The definitions of the parent, minus the ones overridden here
+    const DefinitionsView parentView(*(mc->parent));
+    total += parentView.size();
+
+    for(const DefinitionTable::Entry& entry: mc->defines)
+        total -= parentView.count(*entry.name());
+
+    for(const std::string& removed: mc->removedNames)
+        total -= parentView.count(removed);
+
+    return total;
+}
 
 /*** MacroDatabase ***/
 
 // Default constructor
 
 MacroContainer::MacroContainer()
-: defines(), origins(), nbRedefined(0)
-{
-    // Set large default presize fro the hashing table
-    defines.reserve(50000);
-}
+: defines(), objectLikeNames(), functionLikeNames(), origins(), nbRedefined(0), evaluations(), revision(0), removalRevision(0), parent(nullptr), removedNames()
+{}
 
 bool MacroContainer::exists(const std::string& macroName) const
 {
-    for(const auto& p: defines){
-        if(p.first == macroName )
-            return true;
-    }
-    return false;
+    auto range = getDefines().equal_range(macroName);
+    return range.first != range.second;
 }
 
 bool MacroContainer::alreadyExists(const std::string& macroName, const std::string& macroValue) const
 {
-    auto range = defines.equal_range(macroName);
+    auto range = getDefines().equal_range(macroName);
     for(auto it=range.first; it!=range.second; ++it){
         if(it->second == macroValue && it->first==macroName){
             return true;
@@ -59,49 +224,223 @@ bool MacroContainer::alreadyExists(const std::string& macroName, const std::stri
 
 void MacroContainer::compress()
 {
-    /*for(auto& p: defines)
-    {
-        p.first.shrink_to_fit();
-        p.second.shrink_to_fit();
-    }*/
+    // The strings are already shared through the pool, only the table can be shrunk
+    defines.shrink();
+}
+
+void MacroContainer::reserve(std::size_t nbNewDefinitions)
+{
+    // A child only stores its differences, most of the definitions won't be stored here
+    if(!parent)
+        defines.reserve(defines.nbNames()+nbNewDefinitions);
 }
 
 void MacroContainer::emplace(const std::string& macroName, const std::string& macroValue)
 {
-    auto range = defines.equal_range(macroName);
-    int occurences = 0;
+    emplacePooled(StringPool::intern(macroName), StringPool::intern(macroValue));
+}
 
-    for(auto it=range.first; it!=range.second; ++it)
+void MacroContainer::emplacePooled(const std::string* macroName, const std::string* macroValue)
+{
+    storePooled(macroName, macroValue);
+    definitionStored(macroName, macroValue);
+}
+
+void MacroContainer::definitionStored(const std::string* macroName, const std::string* macroValue)
+{
+    (void) macroName;
+    (void) macroValue;
+}
+
+void MacroContainer::definitionsRemoved()
+{
+}
+
+void MacroContainer::storePooled(const std::string* macroName, const std::string* macroValue)
+{
+    if(parent)
     {
-        if(macroValue==it->second)
+        // Nothing to store here if the parent already gives this definition
+        if(defines.count(*macroName) == 0 && removedNames.count(*macroName) == 0 && parent->alreadyExists(*macroName, *macroValue))
             return;
 
-        ++occurences;
+        overrideName(*macroName);
     }
 
+    // The definitions of a name are kept in the order they were added
+    const std::size_t occurences = defines.add(macroName, macroValue);
+
+    // This definition was already there
+    if(occurences == DefinitionTable::npos)
+        return;
+
     // If something
     if(occurences == 1)
     {
         ++nbRedefined;
     }
+    else if(occurences == 0)
+    {
+        indexName(macroName);
+    }
+
+    markChanged(false);
+}
+
+void MacroContainer::markChanged(bool removal)
+{
+    evaluations.clear();
+    ++revision;
+
+    if(removal)
+        ++removalRevision;
+}
+
+EvaluationCache& MacroContainer::getEvaluationCache() const
+{
+    // The results depend on the definitions of the parents too
+    if(parent)
+        evaluations.synchronize(getRevision());
+
+    return evaluations;
+}
+
+void MacroContainer::setParent(const MacroContainer* newParent)
+{
+    // The revisions must keep increasing, even if the parent changes
+    revision = getRevision()+1;
+    removalRevision = getRemovalRevision()+1;
+
+    parent = newParent;
+    removedNames.clear();
+
+    if(parent)
+    {
+        revision -= parent->getRevision();
+        removalRevision -= parent->getRemovalRevision();
+    }
 
-    defines.emplace(macroName, macroValue);
+    evaluations.clear();
+}
+
+void MacroContainer::flatten()
+{
+    if(!parent)
+        return;
+
+    const unsigned totalRedefined = countRedefined();
+
+    // The definitions are listed first, otherwise the names copied would be considered as overridden
+    std::vector< std::pair<const std::string*, const std::string*> > inherited;
+    for(const auto& p: DefinitionsView(*parent))
+    {
+        if(!overrides(p.first, parent))
+            inherited.emplace_back(&p.first, &p.second);
+    }
+
+    for(const auto& p: inherited)
+    {
+        if(defines.add(p.first, p.second) == 0)
+            indexName(p.first);
+        definitionStored(p.first, p.second);
+    }
+
+    nbRedefined = totalRedefined;
+
+    // Nothing visible changed, but the revisions must not go back
+    revision = getRevision();
+    removalRevision = getRemovalRevision();
+    parent = nullptr;
+    removedNames.clear();
+}
+
+void MacroContainer::overrideName(const std::string& macroName)
+{
+    if(defines.count(macroName) > 0)
+        return;
+
+    // The name was removed here, it starts again from nothing
+    if(removedNames.erase(macroName) > 0)
+        return;
+
+    auto range = DefinitionsView(*parent).equal_range(macroName);
+    if(range.first == range.second)
+        return;
+
+    const std::string* pooledName = &(range.first->first);
+    indexName(pooledName);
+    for(auto it=range.first; it!=range.second; ++it)
+        defines.add(pooledName, &(it->second));
+
+    if(std::distance(range.first, range.second) > 1)
+        ++nbRedefined;
+}
+
+bool MacroContainer::overrides(const std::string& macroName, const MacroContainer* layer) const
+{
+    for(const MacroContainer* mc=this; mc && mc!=layer; mc=mc->parent)
+    {
+        if(mc->defines.find(macroName) || mc->removedNames.count(macroName) > 0)
+            return true;
+    }
+
+    return false;
+}
+
+void MacroContainer::indexName(const std::string* macroName)
+{
+    if(!macroName->empty() && macroName->back() == ')')
+        functionLikeNames.insert(macroName);
+    else
+        objectLikeNames.insert(macroName);
+}
+
+/** \brief add the names of a sorted set starting with a word to an array.
+ */
+static void listStartingWith(const std::set<const std::string*, PooledStringLess>& names, const std::string& word, std::vector<const std::string*>& found)
+{
+    for(auto it=names.lower_bound(&word); it!=names.end() && (*it)->compare(0, word.size(), word) == 0; ++it)
+        found.push_back(*it);
+}
+
+void MacroContainer::listNamesStartingWith(const std::string& word, std::vector<const std::string*>& objectLike, std::vector<const std::string*>& functionLike) const
+{
+    listStartingWith(objectLikeNames, word, objectLike);
+    listStartingWith(functionLikeNames, word, functionLike);
+
+    if(!parent)
+        return;
+
+    // The names of the parents that are not overridden here
+    std::vector<const std::string*> parentObjectLike, parentFunctionLike;
+    parent->listNamesStartingWith(word, parentObjectLike, parentFunctionLike);
+
+    for(const std::string* name: parentObjectLike){
+        if(!overrides(*name, parent))
+            objectLike.push_back(name);
+    }
+
+    for(const std::string* name: parentFunctionLike){
+        if(!overrides(*name, parent))
+            functionLike.push_back(name);
+    }
 }
 
 // Getters
 
 void MacroContainer::import(const MacroContainer& mdatabase)
 {
-    for(const auto& p : mdatabase.defines)
+    // The strings are already pooled, they are not copied
+    for(const auto& p : mdatabase.getDefines())
     {
-        emplace(p.first, p.second);
+        emplacePooled(&p.first, &p.second);
     }
 }
 
 
 bool MacroContainer::isRedefined(const std::string& macroName) const
 {
-    return defines.count(macroName) > 1;
+    return getDefines().count(macroName) > 1;
 }
 
 /*** MacroContainer class implementation ***/
@@ -116,10 +455,33 @@ bool MacroContainer::isNameValid(const std::string& macroContainerName)
     return stillOkay;
 }
 
+void MacroContainer::listPooledStrings(std::unordered_set<const std::string*>& used) const
+{
+    for(const DefinitionTable::Entry& entry: defines)
+    {
+        used.insert(entry.name());
+        for(const std::string* value: entry)
+            used.insert(value);
+    }
+
+    used.insert(objectLikeNames.begin(), objectLikeNames.end());
+    used.insert(functionLikeNames.begin(), functionLikeNames.end());
+}
+
 void MacroContainer::clearDatabase(bool clearDefines, bool clearRedefined, bool clearIncorrect)
 {
-    if(clearDefines)
+    if(clearDefines){
+        // The macros of the parent are not visible anymore either
+        if(parent)
+            setParent(nullptr);
+
         defines.clear();
+        objectLikeNames.clear();
+        functionLikeNames.clear();
+        nbRedefined = 0;
+        markChanged(true);
+        definitionsRemoved();
+    }
 }
 
 
@@ -128,7 +490,7 @@ void MacroContainer::clearDatabase(bool clearDefines, bool clearRedefined, bool
 
 void MacroContainer::searchKeywords(const std::vector<std::string>& keywords, std::ostream& outputStreamResults) const
 {
-    for(const auto& p: defines)
+    for(const auto& p: getDefines())
     {
         bool okay=false;
         for(const std::string& keyword: keywords)
@@ -146,13 +508,7 @@ void MacroContainer::searchKeywords(const std::vector<std::string>& keywords, st
 
 unsigned MacroContainer::countMacroName(const std::string& macroName) const
 {
-    unsigned nb=0;
-    for(const std::pair<std::string,std::string>& p : defines)
-    {
-        if(p.first == macroName)
-            nb++;
-    }
-    return nb;
+    return static_cast<unsigned>(getDefines().count(macroName));
 }
 
 void MacroContainer::printOrigins() const
@@ -162,6 +518,75 @@ void MacroContainer::printOrigins() const
     }
 }
 
+/**< the key used to sort the rows of spacediff by value: the numbers come first in numerical order, then the other values
+     in alphabetical order, and the values that could not be evaluated for sure come last. */
+struct DiffSortKey
+{
+    enum class Bucket { NUMBER, TEXT, UNKNOWN } bucket;
+    bool isInteger;
+    long long integer;
+    double real;
+    std::string text;
+};
+
+/** \brief compute the sort key of a value printed by spacediff (such as "12", "0x40000000", "unknown:A+1" or "1, 2 ?").
+ */
+static DiffSortKey makeDiffSortKey(std::string&& value)
+{
+    DiffSortKey key = { DiffSortKey::Bucket::TEXT, false, 0, 0.0, std::move(value) };
+    const std::string& text = key.text;
+
+    if(text.empty() || text.find("unknown:") != std::string::npos || text.find("undefined:") != std::string::npos || text.back() == '?')
+    {
+        key.bucket = DiffSortKey::Bucket::UNKNOWN;
+        return key;
+    }
+
+    const char* begin = text.c_str();
+    char* end = nullptr;
+
+    // Integers are compared exactly, the other numbers (or the integers that are too large) as floating point values
+    errno = 0;
+    key.integer = std::strtoll(begin, &end, 0);
+    if(end == begin+text.size() && errno == 0)
+    {
+        key.bucket = DiffSortKey::Bucket::NUMBER;
+        key.isInteger = true;
+        key.real = static_cast<double>(key.integer);
+        return key;
+    }
+
+    key.real = std::strtod(begin, &end);
+    if(end == begin+text.size() && !isspace(static_cast<unsigned char>(text.front())))
+        key.bucket = DiffSortKey::Bucket::NUMBER;
+
+    return key;
+}
+
+/** \brief compare two spacediff sort keys, the bucket of the values that could not be evaluated stays last in both orders.
+ *
+ * \param increasing false to sort the values in decreasing order.
+ * \return true if a comes before b.
+ */
+static bool isBefore(const DiffSortKey& a, const DiffSortKey& b, bool increasing)
+{
+    if(a.bucket != b.bucket)
+        return a.bucket < b.bucket;
+
+    const DiffSortKey& first = (increasing ? a : b);
+    const DiffSortKey& second = (increasing ? b : a);
+
+    if(a.bucket == DiffSortKey::Bucket::NUMBER)
+    {
+        if(first.isInteger && second.isInteger)
+            return first.integer < second.integer;
+        if(first.real != second.real)
+            return first.real < second.real;
+    }
+
+    return first.text < second.text;
+}
+
 void MacroContainer::printDiffFromList(std::vector<MacroContainer*>& mcs, const Options& configuration, const std::vector<std::string>& param)
 {
     // Delete all pointers equald to 0 from the vector
@@ -248,23 +673,19 @@ void MacroContainer::printDiff(std::vector<MacroContainer*>& mcs, const Options&
 
     std::vector<const std::string*> commonMacroList;
 
-    for(auto& p : defines)
+    for(const auto& p : getDefines())
     {
+        // The definitions of a same macro are next to each other, the name was already checked
+        if(!commonMacroList.empty() && *commonMacroList.back() == p.first)
+            continue;
+
         bool isCommon=true;
         for(const MacroContainer* mc : mcs)
         {
             if(!mc)
                 continue;
 
-            bool exist=false;
-            for(auto& p2 : mc->defines)
-            {
-                if(p.first == p2.first){
-                    exist=true;
-                    break;
-                }
-            }
-            if(!exist){
+            if(!mc->exists(p.first)){
                 isCommon=false;
                 break;
             }
@@ -273,198 +694,111 @@ void MacroContainer::printDiff(std::vector<MacroContainer*>& mcs, const Options&
         if(isCommon
         && (p.first.size()<3 || !(p.first[p.first.size()-1]==')' && p.first[p.first.size()-2]=='x' && p.first[p.first.size()-3]=='(')))
         {
-            // Let's recheck that the macro does not already exist before pushing it
-            bool good = true;
-            for(const std::string* str : commonMacroList){
-                if(*str == p.first){
-                    good = false;
-                    break;
-                }
-            }
-            if(good){
-                commonMacroList.push_back(&(p.first));
-            }
-
+            commonMacroList.push_back(&(p.first));
         }
     }
 
     std::cout << "Number of common macros: " << commonMacroList.size() << std::endl;
 
-    // Second step: list the result corresponding to these common macros
+    // Second step: evaluate each value once per macrospace, row after row
+    // The evaluations are independent, they are spread over several threads (unless the evaluation steps have to be printed)
+
+    const std::size_t nbSpaces = mcs.size();
+    std::vector<std::string> values(commonMacroList.size()*nbSpaces);
 
-    if(cmp==1)
+    unsigned nbThreads = resolveThreadCount(configuration.getNbThreads());
+    if(configuration.doesPrintReplacements() || configuration.doesPrintExprAtEveryStep())
+        nbThreads = 1;
+
+    parallelFor(values.size(), nbThreads, [&](std::size_t index)
     {
-        // Increasing order
+        const MacroContainer* mc = mcs[index % nbSpaces];
 
-        std::sort(commonMacroList.begin(), commonMacroList.end(), [mcs, configuration](const std::string *a, const std::string *b){
-                std::string aa(*a), bb(*b);
-                calculateExprWithStrOutput(aa, *(mcs.front()), configuration);
-                calculateExprWithStrOutput(bb, *(mcs.front()), configuration);
-                return aa < bb;
-        });
+        if(mc)
+        {
+            std::string& value = values[index];
+            value = mc->getDefines().equal_range(*commonMacroList[index / nbSpaces]).first->second;
+            calculateExprWithStrOutput(value, *mc, configuration);
+        }
+    });
 
-    }
-    else if(cmp==2)
+    // Third step: the order of the rows
+
+    std::vector<std::size_t> rows(commonMacroList.size());
+    for(std::size_t i=0; i<rows.size(); ++i)
+        rows[i] = i;
+
+    if(cmp==1 || cmp==2)
     {
-        // Decreasing order
+        // Increasing or decreasing order, the macros are compared by the value printed for the first macrospace
+        // It was already evaluated, it is only turned into a typed key, so that 0x40000000 comes after 8
+        std::vector<DiffSortKey> keys(commonMacroList.size());
 
-        std::sort(commonMacroList.begin(), commonMacroList.end(), [mcs, configuration](const std::string *a, const std::string *b){
-                std::string aa(*a), bb(*b);
-                calculateExprWithStrOutput(aa, *(mcs.front()), configuration);
-                calculateExprWithStrOutput(bb, *(mcs.front()), configuration);
-                return aa > bb;
-        });
+        for(std::size_t i=0; i<keys.size(); ++i)
+            keys[i] = makeDiffSortKey(std::string(values[i*nbSpaces]));
 
+        const bool increasing = (cmp==1);
+        std::stable_sort(rows.begin(), rows.end(), [&keys, increasing](std::size_t a, std::size_t b){ return isBefore(keys[a], keys[b], increasing); });
     }
     else if(cmp==3)
     {
         // Alpha order
-        std::sort(commonMacroList.begin(),commonMacroList.end(), [](const std::string *a, const std::string *b){ return (*a)<(*b); });
+        std::sort(rows.begin(), rows.end(), [&commonMacroList](std::size_t a, std::size_t b){ return *commonMacroList[a] < *commonMacroList[b]; });
     }
 
+    // Last step: print the rows that are not filtered out
 
-    if(dontdisplayUnknown || dontdisplayUndefined || dontdisplayMultiple || showonlyDifferent)
-    {
+    const bool filtered = (dontdisplayUnknown || dontdisplayUndefined || dontdisplayMultiple || showonlyDifferent);
     unsigned totalDisplayed=0;
 
-    // If the macro is common
-    for(unsigned i=0; i<commonMacroList.size(); ++i)
+    for(std::size_t row: rows)
     {
-        const std::string* str = commonMacroList[i];
+        const std::string* first = nullptr;
+        bool display = true;
+        bool allEqual = true;
 
-        std::vector<std::string> rrr;
-
-        //for(const MacroContainer* mc: mcs)
-        for(unsigned i=0; i<mcs.size(); ++i)
+        for(std::size_t k=0; k<nbSpaces && display; ++k)
         {
-            if(!mcs[i])
+            if(!mcs[k])
                 continue;
 
-            MacroContainer *mc = mcs[i];
-
-            // Show the result of m
-            //auto itFound = std::find(mc->defines.begin(),mc->defines.end(),p.first);
-            auto itf = mc->defines.begin();
-            for(;itf!=mc->defines.end();++itf)
-            {
-                if(itf->first == *str){
-                    break;
-                }
-            }
-
-
-            if(itf != mc->defines.end())
-            {
-                std::string str2 = itf->second;
-
-                calculateExprWithStrOutput(str2, *mc, configuration);
+            const std::string& value = values[row*nbSpaces+k];
 
-                if(dontdisplayUnknown && str2.find("unknown:") != std::string::npos){
-                    rrr.clear();
-                    break;
-                }
+            if((dontdisplayUnknown && value.find("unknown:") != std::string::npos)
+            || (dontdisplayUndefined && value.find("undefined:") != std::string::npos)
+            || (dontdisplayMultiple && value.find(", ") != std::string::npos))
+                display = false;
 
-                if(dontdisplayUndefined && str2.find("undefined:") != std::string::npos){
-                    rrr.clear();
-                    break;
-                }
-
-                if(dontdisplayMultiple && str2.find(", ") != std::string::npos){
-                    rrr.clear();
-                    break;
-                }
-
-                if(showonlyDifferent && !rrr.empty() && rrr.back()==str2){
-                    rrr.clear();
-                    break;
-                }
-
-                rrr.push_back( str2);
-
-                /*if(std::find(mc->redefinedMacros.begin(), mc->redefinedMacros.end(), itf->first) != mc->redefinedMacros.end())
-                    std::cout << '?';*/
-
-
-                if(i < mcs.size()-1)
-                    rrr.push_back( " | " );
-            }
-            else
-                std::cout << "not found"<< std::endl;
+            if(first && *first != value)
+                allEqual = false;
+            first = &value;
         }
 
-        if(!rrr.empty())
-        {
-            std::cout << *str << ": ";
-
-            for(std::string& ss: rrr)
-                std::cout << ss;
+        if(!display || (showonlyDifferent && allEqual))
+            continue;
 
-            std::cout << std::endl;
+        std::cout << *commonMacroList[row] << ": ";
 
-            ++totalDisplayed;
-        }
-
-
-    }
-
-    std::cout << totalDisplayed << " macros were displayed." << std::endl;
-
-    }
-    else
-    {
-
-
-    // If the macro is common
-    for(unsigned i=0; i<commonMacroList.size(); ++i)
-    {
-        const std::string* str = commonMacroList[i];
-
-        std::cout << *str << ": ";
-
-        //for(const MacroContainer* mc: mcs)
-        for(unsigned i=0; i<mcs.size(); ++i)
+        for(std::size_t k=0; k<nbSpaces; ++k)
         {
-            if(!mcs[i])
+            if(!mcs[k])
                 continue;
 
-            MacroContainer *mc = mcs[i];
-
-            // Show the result of m
-            //auto itFound = std::find(mc->defines.begin(),mc->defines.end(),p.first);
-            auto itf = mc->defines.begin();
-            for(;itf!=mc->defines.end();++itf)
-            {
-                if(itf->first == *str){
-                    break;
-                }
-            }
-
+            std::cout << values[row*nbSpaces+k];
 
-            if(itf != mc->defines.end())
-            {
-                std::string str2 = itf->second;
-
-                calculateExprWithStrOutput(str2, *mc, configuration);
-
-                std::cout << str2;
-
-                /*if(std::find(mc->redefinedMacros.begin(), mc->redefinedMacros.end(), itf->first) != mc->redefinedMacros.end())
-                    std::cout << '?';*/
-
-
-                if(i < mcs.size()-1)
-                    std::cout << " | ";
-            }
-            else
-                std::cout << "not found"<< std::endl;
+            if(k < nbSpaces-1)
+                std::cout << " | ";
         }
 
-        std::cout << std::endl;
-    }
-
+        // No flush for each row, it makes a huge difference on large macrospaces
+        std::cout << '\n';
+        ++totalDisplayed;
     }
 
-
+    if(filtered)
+        std::cout << totalDisplayed << " macros were displayed." << std::endl;
+    else
+        std::cout.flush();
 }
 
 
@@ -479,10 +813,19 @@ void MacroContainer::getListOrigins(std::vector<std::string>& v) const
 void MacroContainer::emplaceAndReplace(const std::string& macroName, const std::string& macroValue)
 {
     // 1. Let's add or replace it in the database
-    if(defines.count(macroName)>1)
+    if(parent)
+        removedNames.erase(macroName);
+    const std::string* pooledName = StringPool::intern(macroName);
+    const std::size_t nbRemoved = defines.removeAll(*pooledName);
+    if(nbRemoved>1)
         --nbRedefined;
-    defines.erase(macroName);
-    defines.emplace(macroName, macroValue);
+    if(nbRemoved>0)
+        definitionsRemoved();
+    const std::string* pooledValue = StringPool::intern(macroValue);
+    defines.add(pooledName, pooledValue);
+    indexName(pooledName);
+    markChanged(true);
+    definitionStored(pooledName, pooledValue);
 
     // 2. Let's note where it comes from
     std::string added = "define ";
@@ -492,6 +835,44 @@ void MacroContainer::emplaceAndReplace(const std::string& macroName, const std::
     origins.emplace_back( std::move(added) );
 }
 
+void MacroContainer::erase(const std::string& macroName, const std::string& macroValue)
+{
+    if(removeDefinition(macroName, macroValue))
+        definitionsRemoved();
+}
+
+bool MacroContainer::removeDefinition(const std::string& macroName, const std::string& macroValue)
+{
+    if(parent)
+    {
+        overrideName(macroName);
+
+        // The definitions of the parent must stay hidden once all of them are removed here
+        if(defines.count(macroName) == 1 && **defines.find(macroName)->begin() == macroValue && parent->exists(macroName))
+            removedNames.insert(macroName);
+    }
+
+    const std::size_t occurences = defines.remove(macroName, macroValue);
+
+    // This definition was not there
+    if(occurences == DefinitionTable::npos)
+        return false;
+
+    // The macro won't be redefined anymore
+    if(occurences == 2)
+        --nbRedefined;
+
+    markChanged(true);
+
+    // It was the last definition of the macro
+    if(occurences == 1){
+        objectLikeNames.erase(&macroName);
+        functionLikeNames.erase(&macroName);
+    }
+
+    return true;
+}
+
 const std::vector<std::string>& MacroContainer::getListOrigins() const
 {
     return origins;
@@ -499,14 +880,31 @@ const std::vector<std::string>& MacroContainer::getListOrigins() const
 
 unsigned MacroContainer::countRedefined() const
 {
-    return nbRedefined;
+    if(!parent)
+        return nbRedefined;
+
+    // The redefined macros of the parent, except the ones overridden here
+    unsigned total = nbRedefined + parent->countRedefined();
+
+    for(const DefinitionTable::Entry& entry: defines)
+    {
+        if(parent->isRedefined(*entry.name()))
+            --total;
+    }
+
+    for(const std::string& removed: removedNames){
+        if(parent->isRedefined(removed))
+            --total;
+    }
+
+    return total;
 }
 
 unsigned MacroContainer::countIncorrectOrEmpty() const
 {
     unsigned total=0;
 
-    for(const auto& p: defines)
+    for(const auto& p: getDefines())
     {
         if(!doesExprLookOk(p.second))
             ++total;
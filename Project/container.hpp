@@ -23,7 +23,180 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <mutex>
+#include <iterator>
+#include <cstddef>
+
+#include "stringpool.hpp"
+#include "definitiontable.hpp"
+
 class Options;
+class MacroContainer;
+
+/**< A cache of the results of the evaluations made with a database of macros.
+     It has to be emptied each time the database changes. Copying it gives an empty cache. */
+class EvaluationCache
+{
+public:
+    EvaluationCache();
+    EvaluationCache(const EvaluationCache&);
+    EvaluationCache& operator=(const EvaluationCache&);
+
+    /** \brief look for the result of an evaluation.
+     *
+     * \param key describes the evaluation (the expression and the definitions chosen for redefined macros).
+     * \param result the result found.
+     * \return true if the result was found, false otherwise.
+     */
+    bool find(const std::string& key, std::string& result) const;
+
+    /** \brief store the result of an evaluation.
+     *
+     * \param key describes the evaluation (the expression and the definitions chosen for redefined macros).
+     * \param result the result of the evaluation.
+     */
+    void store(const std::string& key, const std::string& result);
+
+    /** \brief forget every result stored.
+     */
+    void clear();
+
+    /** \brief forget every result stored if they were computed with another revision of the database.
+     *
+     * \param currentRevision the revision of the database (including the revisions of its parents).
+     */
+    void synchronize(unsigned long long currentRevision);
+
+private:
+    /**< evaluations may happen on several threads at the same time. */
+    mutable std::mutex mutex;
+    /**< the results stored by key. */
+    std::unordered_map< std::string, std::string > results;
+    /**< the revision of the database the results were computed with (only used by the databases having a parent). */
+    unsigned long long revision;
+};
+
+/**< A definition of a macro: its name and its value, both stored in the string pool (their addresses stay valid). */
+struct Definition
+{
+    Definition(const std::string& first, const std::string& second)
+    : first(first), second(second)
+    {}
+
+    const std::string& first;
+    const std::string& second;
+};
+
+/**< Gives access to a definition built on the fly through operator->. */
+struct DefinitionPointer
+{
+    inline const Definition* operator->() const { return &definition; }
+
+    Definition definition;
+};
+
+/**< The definitions visible from a database of macros: its own definitions, then the definitions of its parents that it does not override.
+     It can be used like the const std::unordered_multimap of the definitions, the definitions of a same name stay next to each other. */
+class DefinitionsView
+{
+public:
+    /**< iterates over the values of a name in a single database. */
+    class value_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Definition value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef DefinitionPointer pointer;
+        typedef Definition reference;
+
+        value_iterator() : name(nullptr), current(nullptr) {}
+        value_iterator(const std::string* name, const std::string* const* current) : name(name), current(current) {}
+
+        inline reference operator*() const { return Definition(*name, **current); }
+        inline pointer operator->() const { return DefinitionPointer{ **this }; }
+
+        inline value_iterator& operator++() { ++current; return *this; }
+        inline value_iterator operator++(int) { value_iterator previous = *this; ++current; return previous; }
+
+        inline bool operator==(const value_iterator& other) const { return current == other.current; }
+        inline bool operator!=(const value_iterator& other) const { return current != other.current; }
+
+    private:
+        /**< the name whose values are iterated. */
+        const std::string* name;
+        /**< the value currently pointed. */
+        const std::string* const* current;
+    };
+
+    /**< iterates over the definitions of the database, then over the ones of its parents that are not overridden. */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Definition value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef DefinitionPointer pointer;
+        typedef Definition reference;
+
+        const_iterator();
+
+        inline reference operator*() const { return Definition(*entry->name(), **current); }
+        inline pointer operator->() const { return DefinitionPointer{ **this }; }
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        inline bool operator==(const const_iterator& other) const { return layer == other.layer && (layer == nullptr || current == other.current); }
+        inline bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class DefinitionsView;
+
+        /** \brief iterator on the first definition visible from a database.
+         */
+        explicit const_iterator(const MacroContainer* top);
+
+        /** \brief move forward until a name that is not overridden is found (or until the end).
+         */
+        void skipOverridden();
+
+        /**< the database the definitions are visible from. */
+        const MacroContainer* top;
+        /**< the database (top or one of its parents) currently iterated, nullptr at the end. */
+        const MacroContainer* layer;
+        /**< the name currently pointed in layer. */
+        const DefinitionTable::Entry* entry;
+        /**< the value currently pointed in entry. */
+        const std::string* const* current;
+    };
+
+    explicit DefinitionsView(const MacroContainer& container)
+    : container(&container)
+    {}
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /** \brief get the definitions of a name, from the database or from the first parent defining it.
+     */
+    std::pair<value_iterator, value_iterator> equal_range(const std::string& macroName) const;
+
+    /** \brief get the number of definitions of a name.
+     */
+    std::size_t count(const std::string& macroName) const;
+
+    /** \brief get the number of definitions visible.
+     */
+    std::size_t size() const;
+
+    inline bool empty() const { return begin() == end(); }
+
+private:
+    const MacroContainer* container;
+};
 
 /**< A database of macros defined by name and listing from where the macros come from. */
 class MacroContainer
@@ -33,6 +206,8 @@ public:
      */
     MacroContainer();
 
+    virtual ~MacroContainer() = default;
+
     /** \brief add a new macro to the database.
      *
      * \param macroName the name of the macro.
@@ -40,6 +215,13 @@ public:
      */
     void emplace(const std::string& macroName, const std::string& macroValue);
 
+    /** \brief add a new macro whose name and value are already stored in the string pool (no string is copied).
+     *
+     * \param macroName the pooled name of the macro.
+     * \param macroValue its pooled value.
+     */
+    void emplacePooled(const std::string* macroName, const std::string* macroValue);
+
     /** \brief import the macros from another database into this database.
      *
      * \param macrodatabase the other database from which we want to merge the macros.
@@ -50,12 +232,60 @@ public:
      */
     void compress();
 
+    /** \brief prepare the database to receive new definitions, so that the hash table is grown only once.
+     *
+     * \param nbNewDefinitions the number of definitions about to be added.
+     */
+    void reserve(std::size_t nbNewDefinitions);
+
     // Getters
-    inline const std::unordered_multimap< std::string, std::string >& getDefines() const { return defines; }
+    inline DefinitionsView getDefines() const { return DefinitionsView(*this); }
     bool exists(const std::string& macroName) const;
     bool isRedefined(const std::string& macroName) const;
     bool alreadyExists(const std::string& macroName, const std::string& macroValue) const;
 
+    /** \brief list the macros whose name starts with a word (for instance "MAX" gives "MAX", "MAXIMUM" and "MAX(a,b)").
+     *
+     * \param word the beginning of the names we are looking for.
+     * \param objectLike the names found without parameters are added to this array.
+     * \param functionLike the names found with parameters are added to this array.
+     */
+    void listNamesStartingWith(const std::string& word, std::vector<const std::string*>& objectLike, std::vector<const std::string*>& functionLike) const;
+
+    /** \brief get the cache of the evaluations made with this database, it is emptied each time the database (or one of its parents) changes.
+     */
+    EvaluationCache& getEvaluationCache() const;
+
+    /** \brief get the revision of the database, it is increased each time macros are added or removed (here or in a parent).
+     */
+    inline unsigned long long getRevision() const { return revision + (parent ? parent->getRevision() : 0); }
+
+    /** \brief get the number of times macros were removed from the database (or from its parents).
+     *         As long as it does not change, the database only grew and the databases built from it can be updated by merging it again.
+     */
+    inline unsigned long long getRemovalRevision() const { return removalRevision + (parent ? parent->getRemovalRevision() : 0); }
+
+    /** \brief get the database this one overlays, nullptr if there is none.
+     */
+    inline const MacroContainer* getParent() const { return parent; }
+
+    /** \brief overlay this database on top of another one: the macros it does not define itself are looked for in the parent.
+     *         Only the macros added, replaced or removed afterwards are stored here, the parent must outlive this database.
+     *
+     * \param newParent the database to be overlaid (it must not be this database or one of its children).
+     */
+    void setParent(const MacroContainer* newParent);
+
+    /** \brief copy the definitions still visible from the parent into this database, which no longer depends on it.
+     */
+    void flatten();
+
+    /** \brief list the pooled strings the database refers to (the ones of its parent are not listed).
+     *
+     * \param used the addresses of the strings are added to this set.
+     */
+    void listPooledStrings(std::unordered_set<const std::string*>& used) const;
+
 public:
     /// Console related commands
 
@@ -136,20 +366,86 @@ public:
      */
     void emplaceAndReplace(const std::string& macroName, const std::string& macroValue);
 
+    /** \brief remove one definition of a macro from the collection (other definitions of the macro are kept).
+     *
+     * \param macroName the name of the macro.
+     * \param macroValue the definition to be removed.
+     */
+    void erase(const std::string& macroName, const std::string& macroValue);
+
 protected:
+    /** \brief add a name to the sorted index of names (nothing is done if it is already there).
+     */
+    void indexName(const std::string* macroName);
+
     /** \brief Add a new source (to track from where the imported macros come from).
      *
      * \param newOrigin a source (it could be file, the user..).
      */
     void addOrigin(const std::string& newOrigin);
 
+    /** \brief add a macro whose name and value are already pooled, without calling definitionStored().
+     */
+    void storePooled(const std::string* macroName, const std::string* macroValue);
+
+    /** \brief called each time a definition is stored by emplace(), emplaceAndReplace(), a snapshot.. (even if it was already there),
+     *         so that a derived database can tell which definitions do not only come from its own bookkeeping.
+     */
+    virtual void definitionStored(const std::string* macroName, const std::string* macroValue);
+
+    /** \brief remove one definition of a macro, without calling definitionsRemoved().
+     *
+     * \return false if this definition was not there.
+     */
+    bool removeDefinition(const std::string& macroName, const std::string& macroValue);
+
+    /** \brief called each time definitions are deleted by clearDatabase(), erase() or replaced by emplaceAndReplace(),
+     *         so that a derived database can forget what it knew about them.
+     */
+    virtual void definitionsRemoved();
+
+    /** \brief to be called each time the definitions change: it empties the evaluation cache and increases the revisions.
+     *
+     * \param removal true if definitions were removed.
+     */
+    void markChanged(bool removal);
+
 private:
-    /**< the database definitions */
-    std::unordered_multimap< std::string, std::string > defines;
+    /** \brief before a name defined by the parent is modified here, copy the definitions of the parent (copy-on-write).
+     */
+    void overrideName(const std::string& macroName);
+
+    /** \brief check if this database or one of its children up to a parent defines (or removed) a name itself.
+     *
+     * \param layer a parent of this database, the search stops there.
+     */
+    bool overrides(const std::string& macroName, const MacroContainer* layer) const;
+
+    /**< snapshots read and write the database directly */
+    friend class Snapshot;
+    /**< the view follows the parents */
+    friend class DefinitionsView;
+
+    /**< the database definitions (pooled strings) */
+    DefinitionTable defines;
+    /**< the names of the macros without parameters, sorted so that the names starting with a word are next to each other. */
+    std::set< const std::string*, PooledStringLess > objectLikeNames;
+    /**< the names of the macros with parameters (such as "MAX(a,b)"), sorted too. */
+    std::set< const std::string*, PooledStringLess > functionLikeNames;
     /**< the sources of the database (it describes from where the macros come from) */
     std::vector< std::string > origins;
     /**< counts the number of macros tha thave the same name, but different definitions. */
     unsigned nbRedefined; // redefined macros are counted while loading a file
+    /**< the results of the evaluations made with this database. */
+    mutable EvaluationCache evaluations;
+    /**< increased each time macros are added or removed. */
+    unsigned long long revision;
+    /**< increased each time macros are removed. */
+    unsigned long long removalRevision;
+    /**< the database overlaid by this one, nullptr if there is none. */
+    const MacroContainer* parent;
+    /**< the names defined by the parent whose definitions were all removed from this database. */
+    std::unordered_set< std::string > removedNames;
 };
 
 #endif // CONTAINER_HPP
@@ -0,0 +1,250 @@
+/**
+  ******************************************************************************
+  * @file    definitiontable.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <functional>
+#include <utility>
+
+#include "definitiontable.hpp"
+
+const std::size_t DefinitionTable::npos;
+
+/** \brief hash of a name, reduced to 32 bits.
+ */
+static inline std::uint32_t hashOf(const std::string& name)
+{
+    const std::uint64_t hash = std::hash<std::string>()(name);
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+/** \brief get the number of slots needed for a number of names (the table is kept at most 3/4 full).
+ */
+static std::size_t capacityFor(std::size_t nbNames)
+{
+    std::size_t capacity = 16;
+    while(capacity*3 < nbNames*4)
+        capacity *= 2;
+    return capacity;
+}
+
+DefinitionTable::DefinitionTable()
+: slots(), entries(), nbDefinitions(0)
+{}
+
+std::size_t DefinitionTable::findSlot(const std::string& name, std::uint32_t hash) const
+{
+    if(slots.empty())
+        return npos;
+
+    const std::size_t mask = slots.size()-1;
+
+    for(std::size_t i=(hash & mask); slots[i].entry != 0; i=(i+1) & mask)
+    {
+        if(slots[i].hash == hash)
+        {
+            const std::string* key = entries[slots[i].entry-1].key;
+            if(key == &name || *key == name)
+                return i;
+        }
+    }
+
+    return npos;
+}
+
+const DefinitionTable::Entry* DefinitionTable::find(const std::string& name) const
+{
+    std::size_t slot = findSlot(name, hashOf(name));
+    return (slot == npos ? nullptr : &entries[slots[slot].entry-1]);
+}
+
+std::size_t DefinitionTable::count(const std::string& name) const
+{
+    const Entry* entry = find(name);
+    return (entry ? entry->size() : 0);
+}
+
+std::size_t DefinitionTable::add(const std::string* name, const std::string* value)
+{
+    const std::uint32_t hash = hashOf(*name);
+    std::size_t slot = findSlot(*name, hash);
+
+    // The name already has values, this one goes after them
+    if(slot != npos)
+    {
+        Entry& entry = entries[slots[slot].entry-1];
+        const std::size_t nbValues = entry.size();
+
+        // Two pooled strings are equal only if they are the same
+        for(const std::string* existing: entry){
+            if(existing == value)
+                return npos;
+        }
+
+        if(entry.several.empty()){
+            entry.several.reserve(2);
+            entry.several.push_back(entry.single);
+        }
+        entry.several.push_back(value);
+
+        ++nbDefinitions;
+        return nbValues;
+    }
+
+    // A new name, let's make sure the table does not get too full
+    if(capacityFor(entries.size()+1) > slots.size())
+        rehash(capacityFor(entries.size()+1));
+
+    const std::size_t mask = slots.size()-1;
+    for(slot=(hash & mask); slots[slot].entry != 0; slot=(slot+1) & mask);
+
+    entries.push_back(Entry(name, value));
+    slots[slot].entry = static_cast<std::uint32_t>(entries.size());
+    slots[slot].hash = hash;
+
+    ++nbDefinitions;
+    return 0;
+}
+
+std::size_t DefinitionTable::remove(const std::string& name, const std::string& value)
+{
+    std::size_t slot = findSlot(name, hashOf(name));
+    if(slot == npos)
+        return npos;
+
+    Entry& entry = entries[slots[slot].entry-1];
+    const std::size_t nbValues = entry.size();
+
+    if(nbValues == 1)
+    {
+        if(*entry.single != value)
+            return npos;
+
+        removeEntry(slot);
+        return 1;
+    }
+
+    for(auto it=entry.several.begin(); it!=entry.several.end(); ++it)
+    {
+        if(**it == value)
+        {
+            entry.several.erase(it);
+
+            // The value left goes back inside the entry
+            if(entry.several.size() == 1){
+                entry.single = entry.several.front();
+                std::vector<const std::string*>().swap(entry.several);
+            }
+
+            --nbDefinitions;
+            return nbValues;
+        }
+    }
+
+    return npos;
+}
+
+std::size_t DefinitionTable::removeAll(const std::string& name)
+{
+    std::size_t slot = findSlot(name, hashOf(name));
+    if(slot == npos)
+        return 0;
+
+    const std::size_t nbValues = entries[slots[slot].entry-1].size();
+    removeEntry(slot);
+    return nbValues;
+}
+
+void DefinitionTable::removeEntry(std::size_t slot)
+{
+    const std::size_t index = slots[slot].entry-1;
+    nbDefinitions -= entries[index].size();
+
+    // The last entry takes the place of the one removed, so that the entries stay next to each other
+    if(index+1 != entries.size())
+    {
+        const std::string& lastName = *entries.back().key;
+        slots[findSlot(lastName, hashOf(lastName))].entry = static_cast<std::uint32_t>(index+1);
+        entries[index] = std::move(entries.back());
+    }
+    entries.pop_back();
+
+    // The following slots are shifted back into the free slot when it is between their ideal place and themselves
+    // This way, no slot is ever marked as deleted
+    const std::size_t mask = slots.size()-1;
+    std::size_t hole = slot;
+
+    for(std::size_t i=(hole+1) & mask; slots[i].entry != 0; i=(i+1) & mask)
+    {
+        const std::size_t ideal = slots[i].hash & mask;
+        if(((i-ideal) & mask) >= ((i-hole) & mask)){
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+
+    slots[hole].entry = 0;
+    slots[hole].hash = 0;
+}
+
+void DefinitionTable::rehash(std::size_t capacity)
+{
+    std::vector<Slot> previous(capacity, Slot{0, 0});
+    previous.swap(slots);
+
+    const std::size_t mask = capacity-1;
+
+    // The hashes are stored in the slots, the names don't have to be read again
+    for(const Slot& moved: previous)
+    {
+        if(moved.entry == 0)
+            continue;
+
+        std::size_t slot = moved.hash & mask;
+        while(slots[slot].entry != 0)
+            slot = (slot+1) & mask;
+        slots[slot] = moved;
+    }
+}
+
+void DefinitionTable::clear()
+{
+    std::vector<Slot>().swap(slots);
+    std::vector<Entry>().swap(entries);
+    nbDefinitions = 0;
+}
+
+void DefinitionTable::reserve(std::size_t nbNames)
+{
+    if(capacityFor(nbNames) > slots.size())
+        rehash(capacityFor(nbNames));
+
+    entries.reserve(nbNames);
+}
+
+void DefinitionTable::shrink()
+{
+    if(entries.empty()){
+        clear();
+        return;
+    }
+
+    entries.shrink_to_fit();
+
+    if(capacityFor(entries.size()) < slots.size())
+        rehash(capacityFor(entries.size()));
+}
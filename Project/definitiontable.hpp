@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    definitiontable.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef DEFINITIONTABLE_HPP
+#define DEFINITIONTABLE_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// The definitions of a database are stored in a flat hash table, without any node allocated per definition.
+/// - the entries (a name and its values) are stored next to each other in an array, in the order the names were added.
+/// - the slots form an open-addressing table (linear probing) giving the entry of a name.
+/// Most of the names have a single value, it is stored inside the entry. The values of a redefined name are stored in an array.
+
+class DefinitionTable
+{
+public:
+    /**< a name and its values (pooled strings), in the order they were added. */
+    class Entry
+    {
+    public:
+        inline const std::string* name() const { return key; }
+
+        // The values can be iterated like an array
+        inline const std::string* const* begin() const { return several.empty() ? &single : several.data(); }
+        inline const std::string* const* end() const { return several.empty() ? &single+1 : several.data()+several.size(); }
+        inline std::size_t size() const { return several.empty() ? 1 : several.size(); }
+
+    private:
+        friend class DefinitionTable;
+
+        Entry(const std::string* name, const std::string* value)
+        : key(name), single(value), several()
+        {}
+
+        /**< the name of the macro. */
+        const std::string* key;
+        /**< its value, when it has a single one. */
+        const std::string* single;
+        /**< all its values, when it has several ones (empty otherwise). */
+        std::vector<const std::string*> several;
+    };
+
+    /**< returned when nothing was added or removed. */
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    DefinitionTable();
+
+    /** \brief look for the entry of a name (compared by content, the name does not have to be pooled).
+     *
+     * \return the entry, nullptr if the name has no value.
+     */
+    const Entry* find(const std::string& name) const;
+
+    /** \brief get the number of values of a name.
+     */
+    std::size_t count(const std::string& name) const;
+
+    /** \brief add a value to a name, after its other values.
+     *
+     * \param name the pooled name.
+     * \param value the pooled value.
+     * \return the number of values the name had before, npos if the value was already there (nothing is added).
+     */
+    std::size_t add(const std::string* name, const std::string* value);
+
+    /** \brief remove one value of a name.
+     *
+     * \return the number of values the name had before, npos if the value was not found.
+     */
+    std::size_t remove(const std::string& name, const std::string& value);
+
+    /** \brief remove every value of a name.
+     *
+     * \return the number of values removed.
+     */
+    std::size_t removeAll(const std::string& name);
+
+    /** \brief remove everything and release the memory used.
+     */
+    void clear();
+
+    /** \brief prepare the table to receive names, so that it grows only once.
+     *
+     * \param nbNames the total number of names expected.
+     */
+    void reserve(std::size_t nbNames);
+
+    /** \brief reduce the memory used to what is needed by the current names.
+     */
+    void shrink();
+
+    // The entries can be iterated like an array
+    inline const Entry* begin() const { return entries.data(); }
+    inline const Entry* end() const { return entries.data()+entries.size(); }
+
+    // Getters
+    inline std::size_t size() const { return nbDefinitions; }
+    inline std::size_t nbNames() const { return entries.size(); }
+    inline bool empty() const { return entries.empty(); }
+
+private:
+    /**< a slot of the hash table, it designates an entry. */
+    struct Slot
+    {
+        /**< the index of the entry plus one, 0 if the slot is free. */
+        std::uint32_t entry;
+        /**< the hash of the name, so that most of the names are never compared. */
+        std::uint32_t hash;
+    };
+
+    /** \brief look for the slot designating a name.
+     *
+     * \return the index of the slot, npos if the name is not there.
+     */
+    std::size_t findSlot(const std::string& name, std::uint32_t hash) const;
+
+    /** \brief move the slots to a new table.
+     *
+     * \param capacity the new number of slots (a power of two).
+     */
+    void rehash(std::size_t capacity);
+
+    /** \brief remove the entry designated by a slot, and free the slot.
+     */
+    void removeEntry(std::size_t slot);
+
+    /**< the slots, their number is a power of two (or zero). */
+    std::vector<Slot> slots;
+    /**< the entries, next to each other. */
+    std::vector<Entry> entries;
+    /**< the total number of values. */
+    std::size_t nbDefinitions;
+};
+
+#endif // DEFINITIONTABLE_HPP
@@ -0,0 +1,112 @@
+/**
+  ******************************************************************************
+  * @file    evaluationcheck.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/// A check of the evaluation of macros (stringeval.hpp) on definitions that used to go wrong, it is a program of its own, built from the folder Project:
+/// g++ -std=c++11 -O2 -pthread evaluationcheck/evaluationcheck.cpp arithmetic.cpp stringeval.cpp tokeneval.cpp literals.cpp container.cpp
+///     definitiontable.cpp stringpool.cpp strings.cpp options.cpp threadpool.cpp closestr.cpp -o EvaluationCheck
+/// Each macro is evaluated the way 'look' does, an evaluation that does not end in time is reported as failed.
+/// Usage: EvaluationCheck (exit code 0 when every value is the one expected).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <cstdlib>
+
+#include "../container.hpp"
+#include "../options.hpp"
+#include "../stringeval.hpp"
+
+#define CHECK_TIMEOUT_SECONDS 5 /**< the time an evaluation may take before it is considered endless. */
+
+/**< a few definitions, and the values expected for some macros. */
+struct EvaluationCase
+{
+    const char* description;
+    std::vector< std::pair<std::string, std::string> > definitions;
+    std::vector< std::pair<std::string, std::string> > expected; /**< an empty value is only checked to be computed in time. */
+};
+
+static std::vector<EvaluationCase> makeCases()
+{
+    return {
+        { "macro defined as itself",
+          { {"A", "u.A"} },
+          { {"A", "unknown:u.A"} } },
+        { "member access through a macro of the same name (linux/phonet.h)",
+          { {"pn_e_data", "pn_msg_u.ext.pn_e_data"}, {"pn_e_status", "pn_e_data[1]"} },
+          { {"pn_e_data", "unknown:pn_msg_u.ext.pn_e_data"}, {"pn_e_status", "undefined:pn_msg_u.ext.pn_e_data[1]"} } },
+        { "enumeration value defined as itself (linux/if.h)",
+          { {"IFF_UP", "IFF_UP"}, {"IFF_VOLATILE", "(IFF_UP|8)"} },
+          { {"IFF_UP", "unknown:IFF_UP"}, {"IFF_VOLATILE", "undefined:(IFF_UP|8)"} } },
+        { "macro defined twice, once as itself",
+          { {"B", "u.B"}, {"B", "2"} },
+          { {"B", ""} } },
+        { "macros defined as each other",
+          { {"C", "D.x"}, {"D", "C.y"} },
+          { {"C", "undefined:C.y.x"}, {"D", "undefined:D.x.y"} } },
+        { "macro with parameters calling itself",
+          { {"F(x)", "(F(x)+1)"}, {"G", "F(2)"} },
+          { {"G", ""} } },
+        { "macros used several times",
+          { {"X", "2"}, {"Y", "(X+X*X)"}, {"Z", "(Y-X)"} },
+          { {"Y", "6"}, {"Z", "4"} } }
+    };
+}
+
+int main()
+{
+    const Options options;
+    unsigned nbChecked = 0, nbFailed = 0;
+
+    for(const EvaluationCase& c: makeCases())
+    {
+        MacroContainer container;
+        for(const auto& p: c.definitions)
+            container.emplace(p.first, p.second);
+
+        for(const auto& p: c.expected)
+        {
+            const std::string& name = p.first;
+            ++nbChecked;
+
+            // The evaluation runs in its own thread so that an endless one can be reported
+            std::future<std::string> evaluation = std::async(std::launch::async, [&container, &options, name](){
+                std::string value = name;
+                calculateExprWithStrOutput(value, container, options);
+                return value;
+            });
+
+            if(evaluation.wait_for(std::chrono::seconds(CHECK_TIMEOUT_SECONDS)) != std::future_status::ready){
+                std::cout << "FAILED " << c.description << ": the evaluation of " << name << " does not end." << std::endl;
+                std::_Exit(1);
+            }
+
+            const std::string value = evaluation.get();
+            if(!p.second.empty() && value != p.second){
+                std::cout << "FAILED " << c.description << ": " << name << " is " << value << " instead of " << p.second << std::endl;
+                ++nbFailed;
+            }
+        }
+    }
+
+    std::cout << nbChecked << " values checked, " << nbFailed << " failed." << std::endl;
+    return (nbFailed == 0 ? 0 : 1);
+}
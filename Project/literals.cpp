@@ -1,306 +1,187 @@
-/**
-  ******************************************************************************
-  * @file    hexa.cpp
-  * @author  MCD Application Team
-  * @brief   Macro-Parser
-  *
-  ******************************************************************************
-  * @attention
-  *
-  * Copyright (c) 2022 STMicroelectronics.
-  * All rights reserved.
-  *
-  * This software is licensed under terms that can be found in the LICENSE file
-  * in the root directory of this software component.
-  * If no LICENSE file comes with this software, it is provided AS-IS.
-  *
-  ******************************************************************************
-  */
-
-#include <iostream>
-#include <cctype>
-#include <cmath>
-#include <cstring>
-
-#include "literals.hpp"
-
-using std::string;
-
-/// HEXADECIMAL CONVERSIONS. ///
-
-static bool isStrictHexaLetter(char c)
-{
-    return ( (c>='0' && c<='9') || (c>='a' && c<='f') || (c>='A' && c<='F') );
-}
-
-bool isHexaLetter(char c)
-{
-    return isStrictHexaLetter(c)||c=='x'||c=='X';
-}
-
-static std::size_t findTheX(const std::string& str)
-{
-    // lets first try to look for a small x.
-    auto searchedX = str.find('x');
-
-    // if we didnt found anything, lets look for a big X.
-    if(searchedX == std::string::npos)
-        searchedX = str.find('X');
-
-    // lets return the result of our search.
-    return searchedX;
-}
-
-
-// This function looks for hexadecimal numbers and try to replace them by decimal number
-void locateAndReplaceHexa(std::string& str, const Options& options)
-{
-    std::size_t searchedX = findTheX(str);
-
-    // As long as there is an hexadecimal number ( we locate it by the 'x' character and the 2 digits around it)
-    while(searchedX != std::string::npos
-    //&& isdigit(str[searchedX-1]) && isdigit(str[searchedX+1]) )
-    && isStrictHexaLetter(str[searchedX-1]) && isStrictHexaLetter(str[searchedX+1]))
-    {
-        std::size_t k = searchedX;
-        while(isStrictHexaLetter(str[++k]));
-
-        string endStr=string(&str[k]);
-        string begStr=str.substr(0, searchedX-1);
-        string midStr=str.substr(begStr.size(), str.size()-begStr.size()-endStr.size());
-
-        /*cout << "endStr:" << endStr << "'" << endl;
-        cout << "begStr:" << begStr << "'" << endl;
-        cout << "midStr:" << midStr << "'" << endl;*/
-
-        str = begStr + std::to_string(convertHexaToDeci(midStr)) + endStr;
-
-        if(options.doesPrintExprAtEveryStep())
-        {
-            std::cout << str << std::endl;
-        }
-
-        searchedX = findTheX(str);
-    }
-
-}
-
-long long convertHexaToDeci(const std::string& hex)
-{
-    long long decimal = 0;
-    int i = 0, val = 0;
-
-    /* Find the length of total number of hex digit */
-    std::size_t len = hex.size();
-    if (len == 0)
-        return 0;
-    len--;
-
-    /*
-     * Iterate over each hex digit
-     */
-    for(i=0; hex[i]!='\0'; i++)
-    {
-
-        /* Find the decimal representation of hex[i] */
-        if(hex[i]>='0' && hex[i]<='9')
-        {
-            val = hex[i] - 48;
-        }
-        else if(hex[i]>='a' && hex[i]<='f')
-        {
-            val = hex[i] - 97 + 10;
-        }
-        else if(hex[i]>='A' && hex[i]<='F')
-        {
-            val = hex[i] - 65 + 10;
-        }
-        else if(hex[i] != 'x' && hex[i] != 'X') {
-            std::cerr << "/!\\ Unknown character: " << hex[i] << ". /!\\\n";
-            break;
-        }
-
-
-        decimal += static_cast<long long>(val * pow(16, len));
-        len--;
-    }
-
-    #ifdef DEBUG_LOG_STRINGEVAL
-    printf("Hexadecimal number = %s\n", hex.c_str());
-    printf("Decimal number = %d\n", decimal);
-    #endif
-
-    return decimal;
-}
-
-string convertDeciToHexa(long int num)
-{
-   char arr[100];
-   int i = 0;
-   while(num!=0 && i<100) {
-      int temp = 0;
-      temp = num % 16;
-      if(temp < 10) {
-         arr[i] = temp + 48;
-         i++;
-      } else {
-         arr[i] = temp + 55;
-         i++;
-      }
-      num = num/16;
-   }
-
-   string myreturn;
-
-   for(int j=i-1; j>=0; j--)
-        myreturn += arr[j];
-
-    return myreturn;
-}
-
-bool tryConvertToHexa(std::string& deciStr)
-{
-    long int myint = std::atol(deciStr.c_str());
-
-    // Conversion to long int: okay
-    // We only convert numbers > 250, otherwise they should be written as decimal numbers
-    if(myint > 250)
-    {
-        // Let's reconvert it to hexa.
-        deciStr = "0x";
-        deciStr += convertDeciToHexa(myint);
-        return true;
-    }
-
-    return false;
-}
-
-
-/// INTEGER SUFFIXES DELETION. ///
-
-// lets delete integer suffixes from number contained inside of a string.
-void locateAndReplaceEnding(std::string& str, const Options& options)
-{
-
-    restart:
-
-    int startpos = -1;
-
-    for(unsigned i=0; i<str.size(); ++i)
-    {
-        // Let's note it when we reach a digit
-        if(startpos == (-1) && isdigit(str[i]))
-        {
-            startpos = i;
-        }
-        else if(startpos != (-1) && (str[i] == 'U' || str[i]=='L' || str[i]=='l' || str[i]=='u'))
-        {
-            //std::cout << "RRR:" << str.substr(startpos, i-startpos) << std::endl;
-
-            //std::cout << "BBEF:" << str << std::endl;
-
-            str = str.substr(0, i) + str.substr(i+1);
-
-            //std::cout << "AFTE:" << str << std::endl;
-
-            goto restart;
-        }
-        else if(!isdigit(str[i]))
-            startpos = (-1);
-    }
-
-
-}
-
-
-/// OCTAL CONVERSIONS. ///
-
-static unsigned octalToDecimal(const string& s)
-{
-    unsigned occ=0;
-
-    for(unsigned i=0; i<s.size(); ++i)
-    {
-        occ = occ + (s[i]-'0')*static_cast<unsigned>(pow(8, s.size()-1-i));
-    }
-
-    return occ;
-}
-
-static bool isOctal(char c)
-{
-    return (c >= '0' && c <= '7');
-}
-
-void locateAndReplaceOctal(std::string& str, const Options& options)
-{
-    string s;
-
-    for(unsigned i=1; i<str.size()+1; ++i)
-    {
-        if((i<2 || !isdigit(str[i-2])) && str[i-1]=='0' && isOctal(str[i]) && (i<2 || str[i-2]!='\'' || i<3 || !isdigit(str[i-3])))
-        {
-            s = str[i];
-        }
-        else if(!s.empty() && isdigit(str[i]))
-        {
-            if(isOctal(str[i]))
-            {
-                s += str[i];
-            }
-            else
-            {
-                s.clear();
-            }
-        }
-        else if(!s.empty())
-        {
-            str.replace(i-s.size()-1, s.size()+1, std::to_string(octalToDecimal(s)));
-            locateAndReplaceOctal(str, options);
-            break;
-        }
-    }
-}
-
-
-/// BINARY CONVERSIONS. ///
-
-void locateAndReplaceBinary(std::string& str, const Options& options)
-{
-    string binaryString;
-
-    for(unsigned i=2; i<str.size()+1; ++i)
-    {
-        if(str[i-2]=='0' && (str[i-1]=='b' || str[i-1]=='B') && (str[i]=='0' || str[i]=='1') )
-        {
-            binaryString = str[i];
-        }
-        else if(!binaryString.empty() && (str[i]=='0' || str[i]=='1'))
-        {
-            binaryString += str[i];
-        }
-        else if(!binaryString.empty())
-        {
-            long result = strtol(binaryString.c_str(), nullptr, 2);
-            str.replace(i-binaryString.size()-2, binaryString.size()+2, std::to_string(result));
-            locateAndReplaceOctal(str, options);
-            break;
-        }
-    }
-}
-
-
-/// APOSTROPHES DELETION. ///
-
-void removeApostrophes(std::string& str)
-{
-    for(unsigned i=1; i<str.size(); ++i)
-    {
-        if(isdigit(str[i-1]) && str[i]=='\'' && isdigit(str[i+1]) )
-        {
-            str.erase(str.begin()+i);
-            removeApostrophes(str);
-            break;
-        }
-    }
-}
+/**
+  ******************************************************************************
+  * @file    hexa.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <iostream>
+#include <cctype>
+#include <cstring>
+
+#include "literals.hpp"
+#include "arithmetic.hpp"
+#include "config.hpp"
+
+using std::string;
+
+/// LITERALS NORMALIZATION. ///
+
+/** \brief check if the integer literals written in the base of a literal have to be converted.
+ */
+static bool isBaseRead(const char* literal, std::size_t size)
+{
+    if(size >= 2 && literal[0] == '0' && (literal[1] == 'x' || literal[1] == 'X')){
+        #ifdef READ_HEXADECIMAL
+            return true;
+        #else
+            return false;
+        #endif
+    }
+
+    if(size >= 2 && literal[0] == '0' && (literal[1] == 'b' || literal[1] == 'B')){
+        #ifdef READ_BINARY
+            return true;
+        #else
+            return false;
+        #endif
+    }
+
+    if(size >= 2 && literal[0] == '0' && isdigit(literal[1])){
+        #ifdef READ_OCTAL
+            return true;
+        #else
+            return false;
+        #endif
+    }
+
+    return true;
+}
+
+/** \brief append a literal to a string, written in decimal if it is an integer.
+ *         Otherwise only its digit separators and its suffixes are removed.
+ */
+static void appendLiteral(const char* literal, std::size_t size, std::string& output)
+{
+    IntegerValue value;
+
+    if(isBaseRead(literal, size) && readIntegerLiteral(literal, size, value))
+    {
+        output += integerToString(value);
+        return;
+    }
+
+    while(size > 0 && (literal[size-1]=='u' || literal[size-1]=='U' || literal[size-1]=='l' || literal[size-1]=='L'))
+        --size;
+
+    for(std::size_t i=0; i<size; ++i)
+    {
+        if(literal[i] != '\'')
+            output += literal[i];
+    }
+}
+
+void normalizeLiterals(std::string& str, const Options& options)
+{
+    std::string normalized;
+    normalized.reserve(str.size());
+
+    std::size_t i = 0;
+
+    while(i < str.size())
+    {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+        std::size_t end = i+1;
+
+        if(isalpha(c) || c == '_' || c == '.')
+        {
+            // The identifiers and the decimal parts of numbers are copied as they are, even if they contain digits
+            while(end < str.size() && (isalnum(static_cast<unsigned char>(str[end])) || str[end] == '_'))
+                ++end;
+
+            normalized.append(str, i, end-i);
+        }
+        else if(isdigit(c))
+        {
+            // Let's take every character that may belong to the literal, appendLiteral() deals with the wrong ones
+            while(end < str.size() && (isalnum(static_cast<unsigned char>(str[end])) || str[end] == '\'' || str[end] == '.'))
+                ++end;
+
+            appendLiteral(str.data()+i, end-i, normalized);
+        }
+        else
+        {
+            normalized += str[i];
+        }
+
+        i = end;
+    }
+
+    if(normalized != str)
+    {
+        str.swap(normalized);
+
+        if(options.doesPrintExprAtEveryStep())
+            std::cout << str << std::endl;
+    }
+}
+
+
+/// HEXADECIMAL CONVERSIONS. ///
+
+static bool isStrictHexaLetter(char c)
+{
+    return ( (c>='0' && c<='9') || (c>='a' && c<='f') || (c>='A' && c<='F') );
+}
+
+bool isHexaLetter(char c)
+{
+    return isStrictHexaLetter(c)||c=='x'||c=='X';
+}
+
+string convertDeciToHexa(unsigned long long num)
+{
+   char arr[100];
+   int i = 0;
+   while(num!=0 && i<100) {
+      int temp = 0;
+      temp = num % 16;
+      if(temp < 10) {
+         arr[i] = temp + 48;
+         i++;
+      } else {
+         arr[i] = temp + 55;
+         i++;
+      }
+      num = num/16;
+   }
+
+   string myreturn;
+
+   for(int j=i-1; j>=0; j--)
+        myreturn += arr[j];
+
+    return myreturn;
+}
+
+bool tryConvertToHexa(std::string& deciStr)
+{
+    IntegerValue value;
+
+    // Only the integers are converted, their values are exact on 64 bits
+    if(!readIntegerLiteral(deciStr.data(), deciStr.size(), value))
+        return false;
+
+    // We only convert numbers > 250, otherwise they should be written as decimal numbers
+    if(value.bits > 250)
+    {
+        // Let's reconvert it to hexa.
+        deciStr = "0x";
+        deciStr += convertDeciToHexa(value.bits);
+        return true;
+    }
+
+    return false;
+}
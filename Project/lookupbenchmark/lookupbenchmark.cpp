@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file    lookupbenchmark.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/// A benchmark of MacroContainer::exists() and MacroContainer::countMacroName() against the scan of every definition they used to do,
+/// it is a program of its own, built from the folder Project:
+/// g++ -std=c++11 -O2 -pthread lookupbenchmark/lookupbenchmark.cpp container.cpp definitiontable.cpp stringpool.cpp -o LookupBenchmark
+/// - the databases hold 10k, 100k and 1M macros (a few of them defined twice), half of the names looked for are not defined.
+/// - the scan goes through every definition for each name, so it is given fewer names: the times are written per lookup.
+/// Usage: LookupBenchmark [nbMacros..]
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+#include "../container.hpp"
+
+#define BENCHMARK_LOOKUPS 1000000 /**< the number of names looked for in the database. */
+#define BENCHMARK_SCAN_WORK 50000000ull /**< the number of definitions the scan may go through (lookups * macros), to keep it in seconds. */
+#define BENCHMARK_REDEFINED_PERCENT 5 /**< the percentage of the names having a second value. */
+
+/**< the definitions before the hash index: an unordered_multimap scanned from beginning to end by exists() and countMacroName(). */
+typedef std::unordered_multimap< std::string, std::string > ScannedDefinitions;
+
+static bool scanExists(const ScannedDefinitions& defines, const std::string& macroName)
+{
+    for(const auto& p: defines){
+        if(p.first == macroName )
+            return true;
+    }
+    return false;
+}
+
+static unsigned scanCountMacroName(const ScannedDefinitions& defines, const std::string& macroName)
+{
+    unsigned nb=0;
+    for(const std::pair<const std::string,std::string>& p : defines)
+    {
+        if(p.first == macroName)
+            nb++;
+    }
+    return nb;
+}
+
+/** \brief time a function called on each name.
+ *
+ * \return the time of a call, in nanoseconds.
+ */
+template<typename Function>
+static double measure(const std::vector<std::string>& names, std::size_t nbNames, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i=0; i<nbNames; ++i)
+        function(names[i]);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count() / nbNames;
+}
+
+static std::string formatTime(double nanoseconds)
+{
+    std::ostringstream oss;
+    if(nanoseconds < 10000.0)
+        oss << static_cast<long>(nanoseconds+0.5) << " ns";
+    else if(nanoseconds < 10000000.0)
+        oss << static_cast<long>(nanoseconds/1000.0+0.5) << " us";
+    else
+        oss << static_cast<long>(nanoseconds/1000000.0+0.5) << " ms";
+    return oss.str();
+}
+
+static void benchmark(std::size_t nbMacros)
+{
+    std::mt19937_64 random(nbMacros);
+
+    MacroContainer container;
+    ScannedDefinitions scanned;
+    std::vector<std::string> names;
+    names.reserve(BENCHMARK_LOOKUPS);
+
+    container.reserve(nbMacros);
+    scanned.reserve(nbMacros);
+
+    for(std::size_t i=0; i<nbMacros; ++i)
+    {
+        const std::string name = "PERIPH" + std::to_string(random() % 1000) + "_REG" + std::to_string(i) + "_Msk";
+        const std::string value = "(0x1UL << " + std::to_string(random() % 32) + ')';
+
+        container.emplace(name, value);
+        scanned.emplace(name, value);
+
+        if(random() % 100 < BENCHMARK_REDEFINED_PERCENT){
+            container.emplace(name, value + "+1");
+            scanned.emplace(name, value + "+1");
+        }
+    }
+
+    // Half of the names are defined, the others are looked for in vain (the scan goes through everything)
+    for(std::size_t i=0; i<BENCHMARK_LOOKUPS; ++i)
+    {
+        const std::size_t n = random() % nbMacros;
+        std::string name = "PERIPH" + std::to_string(random() % 1000) + "_REG" + std::to_string(n) + "_Msk";
+        if(i % 2 == 0)
+            name += "_X";
+        names.push_back(name);
+    }
+
+    std::size_t nbScanned = static_cast<std::size_t>(BENCHMARK_SCAN_WORK / nbMacros);
+    if(nbScanned > names.size())
+        nbScanned = names.size();
+    if(nbScanned == 0)
+        nbScanned = 1;
+
+    volatile std::size_t sink = 0;
+
+    const double existsScan = measure(names, nbScanned, [&](const std::string& name){ sink = sink + scanExists(scanned, name); });
+    const double existsIndex = measure(names, names.size(), [&](const std::string& name){ sink = sink + container.exists(name); });
+    const double countScan = measure(names, nbScanned, [&](const std::string& name){ sink = sink + scanCountMacroName(scanned, name); });
+    const double countIndex = measure(names, names.size(), [&](const std::string& name){ sink = sink + container.countMacroName(name); });
+
+    std::cout << nbMacros << " macros (" << scanned.size() << " definitions):" << std::endl;
+    std::cout << "  exists: scan " << formatTime(existsScan) << ", index " << formatTime(existsIndex)
+              << " per lookup (" << nbScanned << " and " << names.size() << " lookups)." << std::endl;
+    std::cout << "  countMacroName: scan " << formatTime(countScan) << ", index " << formatTime(countIndex)
+              << " per lookup (" << nbScanned << " and " << names.size() << " lookups)." << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::size_t> sizes;
+
+    for(int i=1; i<argc; ++i)
+    {
+        const std::size_t n = static_cast<std::size_t>(std::strtoul(argv[i], nullptr, 10));
+        if(n == 0){
+            std::cerr << "usage: LookupBenchmark [nbMacros..]" << std::endl;
+            return 1;
+        }
+        sizes.push_back(n);
+    }
+
+    if(sizes.empty())
+        sizes = { 10000, 100000, 1000000 };
+
+    for(std::size_t n: sizes)
+        benchmark(n);
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @file    macrograph.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <cctype>
+#include <algorithm>
+#include <limits>
+
+#include "macrograph.hpp"
+#include "vector.hpp"
+
+/** \brief call a function for each identifier of a string, the content of string and character literals is skipped.
+ *
+ * \param str the string to be read.
+ * \param found the function called with the position and the length of each identifier.
+ */
+template<typename Function>
+static void forEachIdentifier(const std::string& str, Function found)
+{
+    std::size_t i = 0;
+
+    while(i < str.size())
+    {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+
+        if(isalpha(c) || c == '_')
+        {
+            std::size_t start = i;
+            while(i < str.size() && (isalnum(static_cast<unsigned char>(str[i])) || str[i] == '_'))
+                ++i;
+            found(start, i-start);
+        }
+        else if(isdigit(c))
+        {
+            // Numbers may have letters inside them (0xFFUL), they are not identifiers
+            while(i < str.size() && (isalnum(static_cast<unsigned char>(str[i])) || str[i] == '_' || str[i] == '.'))
+                ++i;
+        }
+        else if(c == '"' || c == '\'')
+        {
+            for(++i; i < str.size() && str[i] != static_cast<char>(c); ++i){
+                if(str[i] == '\\')
+                    ++i;
+            }
+            ++i;
+        }
+        else
+            ++i;
+    }
+}
+
+/** \brief list the identifiers of a string, the content of string and character literals is skipped.
+ *
+ * \param str the string to be read.
+ * \param identifiers the identifiers found are added to this array (once each).
+ */
+static void extractIdentifiers(const std::string& str, std::vector<std::string>& identifiers)
+{
+    forEachIdentifier(str, [&](std::size_t start, std::size_t length){
+        emplaceOnce(identifiers, str.substr(start, length));
+    });
+}
+
+MacroGraph::MacroGraph(const MacroContainer& macroContainer)
+: names(), nodes(), dependencies(), dependents(), unresolved(), nbReferences(0), order(), cycles(), circular()
+{
+    const auto& dictionary = macroContainer.getDefines();
+
+    // 1. One node per macro name (the definitions of a same name are next to each other)
+    const std::string* previous = nullptr;
+
+    for(auto it=dictionary.begin(); it!=dictionary.end(); ++it)
+    {
+        if(previous && *previous == it->first)
+            continue;
+
+        previous = &it->first;
+
+        std::size_t node = names.size();
+        names.push_back(&it->first);
+        nodes.emplace(it->first, node);
+
+        std::size_t posPar = it->first.find('(');
+        if(posPar != std::string::npos)
+            nodes.emplace(it->first.substr(0, posPar), node);
+    }
+
+    dependencies.resize(names.size());
+    dependents.resize(names.size());
+    unresolved.resize(names.size());
+
+    // 2. The references of the definitions
+    std::vector<std::string> identifiers, parameters;
+
+    for(std::size_t node=0; node<names.size(); ++node)
+    {
+        const std::string& name = *names[node];
+
+        // The parameters of a macro are not references to other macros
+        parameters.clear();
+        std::size_t posPar = name.find('(');
+        if(posPar != std::string::npos)
+            extractIdentifiers(name.substr(posPar), parameters);
+
+        identifiers.clear();
+        auto range = dictionary.equal_range(name);
+        for(auto it=range.first; it!=range.second; ++it)
+            extractIdentifiers(it->second, identifiers);
+
+        for(const std::string& identifier: identifiers)
+        {
+            if(std::find(parameters.begin(), parameters.end(), identifier) != parameters.end())
+                continue;
+
+            auto targets = nodes.equal_range(identifier);
+
+            if(targets.first == targets.second)
+                unresolved[node].push_back(identifier);
+
+            for(auto it=targets.first; it!=targets.second; ++it)
+            {
+                if(std::find(dependencies[node].begin(), dependencies[node].end(), it->second) == dependencies[node].end())
+                {
+                    dependencies[node].push_back(it->second);
+                    dependents[it->second].push_back(node);
+                    ++nbReferences;
+                }
+            }
+        }
+    }
+
+    // 3. The order of evaluation
+    computeOrder();
+}
+
+bool MacroGraph::find(const std::string& macroName, std::size_t& node) const
+{
+    auto range = nodes.equal_range(macroName);
+
+    if(range.first == range.second)
+        return false;
+
+    // The exact name is preferred to the name of a macro whose parameters were omitted
+    node = range.first->second;
+    for(auto it=range.first; it!=range.second; ++it){
+        if(*names[it->second] == macroName)
+            node = it->second;
+    }
+
+    return true;
+}
+
+std::string MacroGraph::substituteValues(const std::string& definition, const std::vector<std::string>& values) const
+{
+    std::string result;
+    std::size_t copied = 0;
+
+    forEachIdentifier(definition, [&](std::size_t start, std::size_t length)
+    {
+        // Only the macros without parameters can be replaced by a value
+        auto range = nodes.equal_range(definition.substr(start, length));
+        for(auto it=range.first; it!=range.second; ++it)
+        {
+            if(values[it->second].empty() || names[it->second]->back() == ')')
+                continue;
+
+            result.append(definition, copied, start-copied);
+            ((result += '(') += values[it->second]) += ')';
+            copied = start+length;
+            return;
+        }
+    });
+
+    result.append(definition, copied, std::string::npos);
+    return result;
+}
+
+void MacroGraph::listUnresolved(std::vector<std::string>& identifiers) const
+{
+    for(const std::vector<std::string>& v: unresolved)
+        identifiers.insert(identifiers.end(), v.begin(), v.end());
+
+    std::sort(identifiers.begin(), identifiers.end());
+    identifiers.erase(std::unique(identifiers.begin(), identifiers.end()), identifiers.end());
+}
+
+void MacroGraph::computeOrder()
+{
+    const std::size_t unvisited = std::numeric_limits<std::size_t>::max();
+    const std::size_t nbNodes = names.size();
+
+    std::vector<std::size_t> index(nbNodes, unvisited), lowlink(nbNodes, 0);
+    std::vector<bool> onStack(nbNodes, false);
+    std::vector<std::size_t> stack;
+
+    // Each frame is a node being explored, and the position of the next dependency to explore
+    std::vector< std::pair<std::size_t, std::size_t> > frames;
+    std::size_t counter = 0;
+
+    order.reserve(nbNodes);
+    circular.assign(nbNodes, false);
+
+    auto visit = [&](std::size_t node)
+    {
+        index[node] = lowlink[node] = counter++;
+        stack.push_back(node);
+        onStack[node] = true;
+        frames.emplace_back(node, 0);
+    };
+
+    for(std::size_t start=0; start<nbNodes; ++start)
+    {
+        if(index[start] != unvisited)
+            continue;
+
+        visit(start);
+
+        while(!frames.empty())
+        {
+            const std::size_t node = frames.back().first;
+
+            if(frames.back().second < dependencies[node].size())
+            {
+                const std::size_t next = dependencies[node][frames.back().second++];
+
+                if(index[next] == unvisited)
+                    visit(next);
+                else if(onStack[next])
+                    lowlink[node] = std::min(lowlink[node], index[next]);
+
+                continue;
+            }
+
+            // Every dependency was explored, the node may be the root of a strongly connected component
+            if(lowlink[node] == index[node])
+            {
+                std::vector<std::size_t> component;
+                std::size_t member;
+
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    component.push_back(member);
+                }
+                while(member != node);
+
+                // The components come out after all the components they depend on
+                order.insert(order.end(), component.rbegin(), component.rend());
+
+                const auto& deps = dependencies[node];
+                if(component.size() > 1 || std::find(deps.begin(), deps.end(), node) != deps.end())
+                {
+                    for(std::size_t m: component)
+                        circular[m] = true;
+                    cycles.push_back(std::move(component));
+                }
+            }
+
+            frames.pop_back();
+
+            if(!frames.empty())
+            {
+                std::size_t parent = frames.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+            }
+        }
+    }
+
+    // The macros depending on a circular definition can't be evaluated either
+    for(std::size_t node: order)
+    {
+        for(std::size_t dependency: dependencies[node]){
+            if(circular[dependency])
+                circular[node] = true;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    macrograph.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef MACROGRAPH_HPP
+#define MACROGRAPH_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "container.hpp"
+
+/**< The dependency graph of a database of macros: each macro is linked to the macros its definitions refer to.
+     The identifiers referring to no macro at all are kept as unresolved leaves.
+     The graph points to the names stored in the database, it must not be used once the database has changed. */
+class MacroGraph
+{
+public:
+    /** \brief build the graph, the identifiers of each definition are extracted once.
+     *
+     * \param macroContainer the database of macros.
+     */
+    explicit MacroGraph(const MacroContainer& macroContainer);
+
+    /** \brief find the node of a macro.
+     *
+     * \param macroName the name of the macro, the parameters of a macro can be omitted ("MAX" finds "MAX(a,b)").
+     * \param node the index of the node found.
+     * \return true if the macro exists, false otherwise.
+     */
+    bool find(const std::string& macroName, std::size_t& node) const;
+
+    // Getters
+    inline std::size_t size() const { return names.size(); }
+    inline std::size_t countReferences() const { return nbReferences; }
+    inline const std::string& getName(std::size_t node) const { return *names[node]; }
+    inline const std::vector<std::size_t>& getDependencies(std::size_t node) const { return dependencies[node]; }
+    inline const std::vector<std::size_t>& getDependents(std::size_t node) const { return dependents[node]; }
+    inline const std::vector<std::string>& getUnresolved(std::size_t node) const { return unresolved[node]; }
+
+    /** \brief get the macros sorted so that each macro comes after all the macros it depends on.
+     *         The macros of a same circular definition are next to each other.
+     */
+    inline const std::vector<std::size_t>& getTopologicalOrder() const { return order; }
+
+    /** \brief get the groups of macros that are defined in a circular way (a macro may refer to itself).
+     */
+    inline const std::vector< std::vector<std::size_t> >& getCycles() const { return cycles; }
+
+    /** \brief check if a macro can't be evaluated because it is part of a circular definition, or because it depends on one.
+     */
+    inline bool isCircular(std::size_t node) const { return circular[node]; }
+
+    /** \brief list the identifiers that are referred to but that are not macros, sorted and without duplicates.
+     */
+    void listUnresolved(std::vector<std::string>& identifiers) const;
+
+    /** \brief replace the references of a definition to macros without parameters by their values, when they are known.
+     *
+     * \param definition the definition of a macro.
+     * \param values the value of each node, empty if it is not known.
+     * \return the definition where the known values are written between parentheses.
+     */
+    std::string substituteValues(const std::string& definition, const std::vector<std::string>& values) const;
+
+private:
+    /** \brief sort the nodes topologically and detect circular definitions (Tarjan's algorithm, without recursion).
+     */
+    void computeOrder();
+
+    /**< the names of the macros, one per node. */
+    std::vector<const std::string*> names;
+    /**< the node of each macro by name (the macros with parameters are found with and without their parameters). */
+    std::unordered_multimap<std::string, std::size_t> nodes;
+    /**< the macros each macro refers to. */
+    std::vector< std::vector<std::size_t> > dependencies;
+    /**< the macros referring to each macro. */
+    std::vector< std::vector<std::size_t> > dependents;
+    /**< the identifiers of each macro that are not macros. */
+    std::vector< std::vector<std::string> > unresolved;
+    /**< the number of edges of the graph. */
+    std::size_t nbReferences;
+
+    /**< the nodes sorted topologically. */
+    std::vector<std::size_t> order;
+    /**< the circular definitions found. */
+    std::vector< std::vector<std::size_t> > cycles;
+    /**< true for the nodes that are part of (or depend on) a circular definition. */
+    std::vector<bool> circular;
+};
+
+#endif // MACROGRAPH_HPP
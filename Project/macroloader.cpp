@@ -3,61 +3,106 @@
 #include <fstream>
 #include <atomic>
 #include <thread>
+#include <cstring>
 #include "stringeval.hpp"
 #include "macrosearch.hpp"
 #include "options.hpp"
 #include "macroloader.hpp"
 #include "config.hpp"
 #include "strings.hpp"
+#include "threadpool.hpp"
+#include "sourcefile.hpp"
 
-/**< detect looks for keywords among source code, when reading a file character by character. */
-class WordDetector
+#define IMPORT_FILES_IN_FLIGHT_PER_THREAD 8 /**< the number of files parsed in advance per thread, while waiting for the previous ones to be merged. */
+
+/**< the preprocessor directives the macro loader takes into account. */
+enum class Directive { NONE, DEFINE, IF, IFDEF, IFNDEF, ELIF, ELSE, ENDIF, INCLUDE };
+
+/** \brief recognize a directive from its name (the word that follows the '#' character).
+ *
+ * \param name the name of the directive.
+ * \param size the number of characters of the name.
+ * \return the directive recognized, or Directive::NONE if the name is not one we deal with.
+ */
+static Directive recognizeDirective(const char* name, std::size_t size)
 {
-public:
-    /** \brief Only possible constructor.
-     *
-     * \param initialstr the string we want to detect, when reading character one by one.
-     */
-    WordDetector(const char* initialstr)
-    : str(initialstr), pos(0)
-    {}
-
-    /** \brief let's take into account a character read.
-     *
-     * \param character read from the file.
-     * \return true if it matches with the complete keyword initially provided, false if it does not.
-     */
-    bool receive(char character)
+    // Let's dispatch on the size of the name first, at most two names share the same size
+    switch(size)
     {
-        if(str[pos]=='\r')
-        {
-            pos=0;
-            if(isspace(character)||character=='(')
-                return true;
-        }
+        case 2:
+            if(name[0]=='i' && name[1]=='f') return Directive::IF;
+            break;
+        case 4:
+            if(strncmp(name, "elif", 4)==0) return Directive::ELIF;
+            if(strncmp(name, "else", 4)==0) return Directive::ELSE;
+            break;
+        case 5:
+            if(strncmp(name, "ifdef", 5)==0) return Directive::IFDEF;
+            if(strncmp(name, "endif", 5)==0) return Directive::ENDIF;
+            break;
+        case 6:
+            if(strncmp(name, "define", 6)==0) return Directive::DEFINE;
+            if(strncmp(name, "ifndef", 6)==0) return Directive::IFNDEF;
+            break;
+        case 7:
+            if(strncmp(name, "include", 7)==0) return Directive::INCLUDE;
+            break;
+        default:
+            break;
+    }
 
-        else if(str[pos]==character
-             ||(str[pos]==' ' && isspace(character)))
-        {
-            ++pos;
-            if(str[pos]=='\0'){
-                pos=0;
-                return true;
-            }
-        }
+    return Directive::NONE;
+}
 
-        else
-            pos=0;
+/** \brief check if a '#' character starts a directive (only spaces are allowed before it on its line).
+ *
+ * \param file the file being read.
+ * \param pos the position of the '#' character.
+ * \param allowLineComment if true, "//" may also come before the '#' character (commented directives).
+ * \return true if the '#' character is the first thing on its line, false otherwise.
+ */
+static bool isAtLineStart(const SourceFile& file, std::size_t pos, bool allowLineComment)
+{
+    const char* content = file.data();
 
-        return false;
+    while(pos > 0)
+    {
+        char c = content[pos-1];
+
+        if(c=='\n' || c=='\r')
+            return true;
+        else if(allowLineComment && c=='/' && pos > 1 && content[pos-2]=='/')
+            pos -= 2;
+        else if(c==' ' || c=='\t')
+            --pos;
+        else
+            return false;
     }
 
-private:
-    /**< the string we want our detector to detect. */
-    const char* str;
-    /**< the position at which we are when matching with the keyword. */
-    int pos;
-};
+    return true;
+}
+
+/** \brief read the directive that follows a '#' character.
+ *
+ * \param file the file being read, positioned just after the '#' character. It is left just after the name of the directive.
+ * \return the directive read.
+ */
+static Directive readDirective(SourceFile& file)
+{
+    const char* content = file.data();
+    std::size_t pos = file.tell();
+
+    // spaces are allowed between '#' and the name of the directive
+    while(pos < file.size() && (content[pos]==' ' || content[pos]=='\t'))
+        ++pos;
+
+    std::size_t beginning = pos;
+    while(pos < file.size() && isMacroCharacter(content[pos]))
+        ++pos;
+
+    file.seek(pos);
+    return recognizeDirective(content+beginning, pos-beginning);
+}
 
 static std::string extractDirPathFromFilePath(const std::string& filepath)
 {
@@ -73,22 +118,10 @@ static std::string extractDirPathFromFilePath(const std::string& filepath)
     while(file.get(characterRead) && characterRead != '\n');
 }*/
 
-static void skipLongComment(std::ifstream& stream)
+static void skipLongComment(SourceFile& stream)
 {
-    //std::cout << "=>long" << std::endl;
-
     // Let's skip the comment in the file, until we reach the end of it
-    // Skip everything from here
-    char k='a';
-    char characterRead;
-    while(stream.get(characterRead)){
-        if(k=='*' && characterRead=='/')
-            break;
-        k=characterRead;
-        //std::cout << characterRead;
-    }
-
-    //std::cout << "<=long" << std::endl;
+    stream.skipPast('*', '/');
 }
 
 static bool destructLongComment(std::string& str)
@@ -107,9 +140,9 @@ static bool destructLongComment(std::string& str)
 }
 
 
-static bool importFile(const char* pathToFile, MacroContainer& macroContainer, const Options& config, MacroContainer* origin)
+static bool importFile(const char* pathToFile, DefinitionList& definitions, const Options& config, MacroContainer* origin)
 {
-    std::ifstream file(pathToFile);
+    SourceFile file(pathToFile);
 
     if(!file.is_open())
         return false;
@@ -120,15 +153,6 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
         std::cout << "Opened " << pathToFile << std::endl;
     #endif
 
-    WordDetector defineDetector("#define ");
-    WordDetector ifdefDetector("#ifdef ");
-    WordDetector elifDetector("#elif\r");
-    WordDetector elseDetector("#else");
-    WordDetector endifDetector("#endif");
-    WordDetector ifndefDetector("#ifndef ");
-    WordDetector includeDetector("#include");
-    WordDetector ifDetector("#if\r");
-
     char characterRead;
 
     int posLineComment=0;
@@ -137,8 +161,27 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
 
     bool firstInstruction=true;
 
-    while(file.get(characterRead))
+    // Only '#' (directives) and '/' (comments) can change the state of the parser.
+    // Let's remember where the next ones are, to jump over everything else.
+    const bool watchComments = !config.doesImportMacroCommented();
+    std::size_t nextHash = file.find('#', 0);
+    std::size_t nextSlash = watchComments ? file.find('/', 0) : file.size();
+
+    while(true)
     {
+        if(posLineComment == 0)
+        {
+            if(nextHash < file.tell())
+                nextHash = file.find('#', file.tell());
+            if(nextSlash < file.tell())
+                nextSlash = file.find('/', file.tell());
+
+            file.seek(nextHash < nextSlash ? nextHash : nextSlash);
+        }
+
+        if(!file.get(characterRead))
+            break;
+
         /// avoid to load defines that are commented
 
         if(!config.doesImportMacroCommented())
@@ -150,7 +193,8 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
                 if(posLineComment == 2)
                 {
                     // we skip the all line
-                    while(file.get(characterRead) && characterRead != '\n');
+                    file.skipLine();
+                    characterRead = '\n';
 
                     // we reset the slash counter
                     posLineComment=0;
@@ -169,10 +213,41 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
                 posLineComment = 0;
         }
 
+        /// recognize the directive, if a '#' character starts the line
+
+        Directive directive = Directive::NONE;
+
+        if(characterRead == '#' && isAtLineStart(file, file.tell()-1, !watchComments))
+        {
+            directive = readDirective(file);
+
+            switch(directive)
+            {
+                case Directive::DEFINE:
+                case Directive::IFDEF:
+                case Directive::IFNDEF:
+                    // a space must come after the name of the directive
+                    if(file.get(characterRead) && !isspace(characterRead)){
+                        file.seek(file.tell()-1);
+                        directive = Directive::NONE;
+                    }
+                    break;
 
+                case Directive::IF:
+                case Directive::ELIF:
+                    // the condition may directly start with a parenthesis
+                    if(file.get(characterRead) && !isspace(characterRead) && characterRead != '('){
+                        file.seek(file.tell()-1);
+                        directive = Directive::NONE;
+                    }
+                    break;
 
+                default:
+                    break;
+            }
+        }
 
-        if(defineDetector.receive(characterRead))
+        if(directive == Directive::DEFINE)
         {
                 firstInstruction = false;
 
@@ -257,7 +332,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
                     string inpLine;
 
                     // we get the next line
-                    getline(file, inpLine);
+                    file.getline(inpLine);
                     clearSpaces(inpLine);
                     str2 += inpLine;
 
@@ -297,8 +372,10 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
                 if((!origin && keepTrack.back()>=0)
                 || (origin && keepTrack.back()>=1)){
                     //std::cout << "import: " << str1 << " --- " << str2 << "---" << (int)keepTrack.back() << std::endl;
-                    macroContainer.emplace(str1, str2);
-                    localContainer.emplace(str1, str2);
+                    const std::string* pooledName = StringPool::intern(str1);
+                    const std::string* pooledValue = StringPool::intern(str2);
+                    definitions.emplace_back(pooledName, pooledValue);
+                    localContainer.emplacePooled(pooledName, pooledValue);
                 }
 
                 if(!config.doDisableInterpretations() && keepTrack.back()>=1){
@@ -320,7 +397,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
         {
 
         // If we detected #if
-        if(ifDetector.receive(characterRead))
+        if(directive == Directive::IF)
         {
             //std::cout << "#if ";
             firstInstruction=false;
@@ -380,7 +457,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
         }
 
         // If we detected ifdef
-        if(ifdefDetector.receive(characterRead))
+        if(directive == Directive::IFDEF)
         {
             //std::cout << "#ifdef";
 
@@ -417,7 +494,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
         }
 
         // If we detected ifndef
-        if(ifndefDetector.receive(characterRead))
+        if(directive == Directive::IFNDEF)
         {
             //std::cout << "entered ifndef" << std::endl;
 
@@ -452,7 +529,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
             firstInstruction=false;
         }
 
-            if(elseDetector.receive(characterRead))
+            if(directive == Directive::ELSE)
             {
                 if(keepTrack.back()==1)
                 {
@@ -465,7 +542,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
             }
 
             // If it is #elif treat it like that
-            if(elifDetector.receive(characterRead))
+            if(directive == Directive::ELIF)
             {
 
                 // If the previous condition was evaluated to false
@@ -541,7 +618,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
             }
 
         // If we detected endif
-        if(endifDetector.receive(characterRead))
+        if(directive == Directive::ENDIF)
         {
             if(keepTrack.size()>1){
                 //std::cout << "#endif => " << last << std::endl;
@@ -552,7 +629,7 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
         }
 
         // If we detected #include
-        if(includeDetector.receive(characterRead))
+        if(directive == Directive::INCLUDE)
         {
             // Let's extract the filename
             string wholeWord;
@@ -579,7 +656,13 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
                 string pathDir = extractDirPathFromFilePath(pathToFile);
                 //std::cout << "asked import of: " << pathDir+'/'+wholeWord << std::endl;
                 if(!origin && !config.doDisableInterpretations())
-                    importFile((pathDir+'/'+wholeWord).c_str(), localContainer, config, &localContainer);
+                {
+                    DefinitionList included;
+                    importFile((pathDir+'/'+wholeWord).c_str(), included, config, &localContainer);
+
+                    for(const auto& p: included)
+                        localContainer.emplacePooled(p.first, p.second);
+                }
             }
         }
 
@@ -596,7 +679,13 @@ static bool importFile(const char* pathToFile, MacroContainer& macroContainer, c
 
 bool MacroLoader::importFromFile(const std::string& filepath, const Options& config)
 {
-    if(importFile(filepath.c_str(), *this, config, nullptr)){
+    DefinitionList definitions;
+
+    if(importFile(filepath.c_str(), definitions, config, nullptr)){
+        reserve(definitions.size());
+        for(const auto& p: definitions)
+            emplacePooled(p.first, p.second);
+
         this->addOrigin(filepath);
         return true;
     }
@@ -614,14 +703,14 @@ static void printNbFilesLoaded(std::atomic<bool>& ended, std::atomic<unsigned>&
 
     while(delayFirstSleep > 0)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(120));
-        delayFirstSleep -= 120;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        delayFirstSleep -= 20;
 
         // we read our atomic variable
         bool myend = ended;
 
         if(myend)
-            break;
+            return;
     }
 
     // We display the loading status, yeah
@@ -655,10 +744,102 @@ static void printNbFilesLoaded(std::atomic<bool>& ended, std::atomic<unsigned>&
 
 #endif
 
-static bool importDirectory(string dir, MacroContainer& macroContainer, const Options& config)
+/** \brief compute the FNV-1a hash of the content of a file.
+ */
+static std::uint64_t hashContent(const char* content, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for(std::size_t i=0; i<size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(content[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**< the result of looking at a file of a folder being imported. */
+struct FileUpdate
+{
+    /**< UNCHANGED: the file is the same as the last import, PARSED: it was parsed, FAILED: it could not be read. */
+    enum { UNCHANGED, PARSED, FAILED } state;
+    /**< the new status of the file. */
+    long long modificationTime;
+    unsigned long long size;
+    std::uint64_t hash;
+    /**< the macros read from the file, when it was parsed. */
+    DefinitionList macros;
+};
+
+void MacroLoader::addContribution(const std::string* macroName, const std::string* macroValue)
+{
+    auto inserted = contributions.emplace(std::make_pair(macroName, macroValue), FolderContribution{ 0, false });
+
+    // A macro that is already there before any file brings it was defined another way
+    if(inserted.second)
+        inserted.first->second.pinned = alreadyExists(*macroName, *macroValue);
+
+    ++inserted.first->second.nbFiles;
+    storePooled(macroName, macroValue);
+}
+
+void MacroLoader::removeContribution(const std::string* macroName, const std::string* macroValue)
+{
+    auto it = contributions.find(std::make_pair(macroName, macroValue));
+
+    if(it != contributions.end() && --(it->second.nbFiles) == 0)
+    {
+        const bool pinned = it->second.pinned;
+        contributions.erase(it);
+
+        if(!pinned)
+            removeDefinition(*macroName, *macroValue);
+    }
+}
+
+void MacroLoader::definitionStored(const std::string* macroName, const std::string* macroValue)
+{
+    if(contributions.empty())
+        return;
+
+    auto it = contributions.find(std::make_pair(macroName, macroValue));
+    if(it != contributions.end())
+        it->second.pinned = true;
+}
+
+void MacroLoader::definitionsRemoved()
+{
+    // The files that did not change since are not parsed again, their macros would not come back otherwise
+    manifests.clear();
+    contributions.clear();
+}
+
+void MacroLoader::listPooledStrings(std::unordered_set<const std::string*>& used) const
+{
+    MacroContainer::listPooledStrings(used);
+
+    for(const auto& manifest: manifests)
+    {
+        for(const auto& record: manifest.second)
+        {
+            for(const auto& macro: record.second.macros){
+                used.insert(macro.first);
+                used.insert(macro.second);
+            }
+        }
+    }
+
+    for(const auto& contribution: contributions){
+        used.insert(contribution.first.first);
+        used.insert(contribution.first.second);
+    }
+}
+
+bool MacroLoader::importFromFolder(const std::string& folderpath, const Options& config)
 {
     std::vector<std::string> fileCollection;
-    explore_directory(dir, fileCollection);
+    explore_directory(folderpath, fileCollection);
 
     if(fileCollection.empty())
         return false;
@@ -666,56 +847,134 @@ static bool importDirectory(string dir, MacroContainer& macroContainer, const Op
     // Let's print the number of files loaded for debugging purposes
     std::cout << "Number of files listed: " << fileCollection.size() << std::endl;
 
-    unsigned localNbFile = 0;
+    // Let's keep only the files we are going to read
+    std::vector<const std::string*> filesToImport;
+    for(const std::string& str: fileCollection)
+    {
+        if(!config.doesImportOnlySourceFileExtension() || hasEnding(str, ".h") || hasEnding(str, ".c") || hasEnding(str, ".cpp") || hasEnding(str, ".hpp"))
+            filesToImport.push_back(&str);
+    }
+
+    // What we know about the files from the previous import of this folder (nothing the first time)
+    const bool firstImport = (manifests.find(folderpath) == manifests.end());
+    std::unordered_map<std::string, FileRecord>& manifest = manifests[folderpath];
+
     #ifdef ENABLE_FILE_LOADING_BAR
     std::cout << std::setprecision(3);
     std::atomic<bool> ended(false);
     std::atomic<unsigned> nbFiles(0);
-    std::thread tr = std::thread(printNbFilesLoaded, std::ref(ended), std::ref(nbFiles), fileCollection.size());
+    std::thread tr = std::thread(printNbFilesLoaded, std::ref(ended), std::ref(nbFiles), filesToImport.size());
     #endif
     #ifdef DISPLAY_FOLDER_IMPORT_TIME
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     #endif // DISPLAY_FOLDER_IMPORT_TIME
 
-    // If interpretation is enabled
-    std::unordered_multimap<std::string,MacroContainer> database;
+    // Each file is parsed in its own list of definitions, so that files can be parsed in parallel
+    // The files parsed are merged as soon as the ones listed before them are, only a few lists wait at the same time
+    std::vector<FileUpdate> updates(filesToImport.size());
+    std::unordered_map<std::string, FileRecord> newManifest;
+    std::size_t nbUnchanged = 0, nbModified = 0, nbAdded = 0;
 
-    for(const std::string& str: fileCollection)
+    const unsigned nbThreads = resolveThreadCount(config.getNbThreads());
+
+    auto parseFile = [&](std::size_t i)
     {
-        if(!config.doesImportOnlySourceFileExtension() || hasEnding(str, ".h") || hasEnding(str, ".c") || hasEnding(str, ".cpp") || hasEnding(str, ".hpp"))
+        const std::string& str = *filesToImport[i];
+        FileUpdate& update = updates[i];
+        update.state = FileUpdate::FAILED;
+
+        try
         {
-            try
+            if(getFileStatus(str.c_str(), update.modificationTime, update.size))
             {
-                MacroContainer mc;
+                // The manifest is only read while the files are processed
+                auto previous = manifest.find(str);
 
-                if(!importFile(str.c_str(), mc, config, nullptr)){
-                    std::cerr << "Couldn't read/open file : " << str << std::endl;
+                if(previous != manifest.end()
+                && previous->second.modificationTime == update.modificationTime
+                && previous->second.size == update.size)
+                {
+                    update.state = FileUpdate::UNCHANGED;
+                    update.hash = previous->second.hash;
                 }
-                else {
-                    database.emplace(str, std::move(mc));
+                else
+                {
+                    SourceFile file(str.c_str());
+                    if(file.is_open())
+                        update.hash = hashContent(file.data(), file.size());
+
+                    // The file was touched, but its content is the same
+                    if(file.is_open() && previous != manifest.end() && previous->second.hash == update.hash)
+                    {
+                        update.state = FileUpdate::UNCHANGED;
+                    }
+                    else
+                    {
+                        if(file.is_open() && importFile(str.c_str(), update.macros, config, nullptr)){
+                            update.macros.shrink_to_fit();
+                            update.state = FileUpdate::PARSED;
+                        }
+                    }
                 }
             }
-            catch(const std::exception& ex)
+
+            if(update.state == FileUpdate::FAILED)
+                std::cerr << "Couldn't read/open file : " << str << std::endl;
+        }
+        catch(const std::exception& ex)
+        {
+            std::cerr << "An error has occured while trying to interpret this source file:" << std::endl;
+            std::cerr << str << std::endl;
+            std::cerr << "Exception message: " << ex.what() << std::endl;
+        }
+
+        #ifdef ENABLE_FILE_LOADING_BAR
+        // let's write to our atomic variable
+        ++nbFiles;
+        #endif
+    };
+
+    auto mergeFile = [&](std::size_t i)
+    {
+        FileUpdate& update = updates[i];
+        auto previous = manifest.find(*filesToImport[i]);
+
+        if(update.state == FileUpdate::UNCHANGED)
+        {
+            // The record of an unchanged file is kept as it is
+            previous->second.modificationTime = update.modificationTime;
+            newManifest.emplace(previous->first, std::move(previous->second));
+            ++nbUnchanged;
+        }
+        else if(update.state == FileUpdate::PARSED)
+        {
+            // The file was modified, let's withdraw what it brought before
+            if(previous != manifest.end())
             {
-                std::cerr << "An error has occured while trying to interpret this source file:" << std::endl;
-                std::cerr << str << std::endl;
-                std::cerr << "Exception message: " << ex.what() << std::endl;
+                for(const auto& p: previous->second.macros)
+                    removeContribution(p.first, p.second);
+                ++nbModified;
             }
+            else
+                ++nbAdded;
 
+            FileRecord record;
+            record.modificationTime = update.modificationTime;
+            record.size = update.size;
+            record.hash = update.hash;
 
+            for(const auto& p: update.macros)
+                addContribution(p.first, p.second);
+            record.macros = std::move(update.macros);
 
+            newManifest.emplace(*filesToImport[i], std::move(record));
         }
+    };
 
-        localNbFile++;
-
-        #ifdef ENABLE_FILE_LOADING_BAR
-        // let's write to our atomic variable
-        nbFiles = localNbFile;
-        #endif
-    }
+    orderedParallelFor(filesToImport.size(), nbThreads, IMPORT_FILES_IN_FLIGHT_PER_THREAD*nbThreads, parseFile, mergeFile);
 
     #ifdef ENABLE_FILE_LOADING_BAR
-    // let's write to our atomic variable&
+    // let's write to our atomic variable
     ended = true;
     tr.join();
     #endif
@@ -724,21 +983,27 @@ static bool importDirectory(string dir, MacroContainer& macroContainer, const Op
     std::cout << "Import time: " << importTime << " ms.\n";
     #endif // DISPLAY_FOLDER_IMPORT_TIME
 
-    for(auto& p: database) {
-        macroContainer.import(p.second);
+    // The files that were removed (or that can't be read anymore), let's withdraw what they brought
+    std::size_t nbRemoved = 0;
+
+    for(const auto& record: manifest)
+    {
+        if(newManifest.count(record.first) == 0)
+        {
+            for(const auto& p: record.second.macros)
+                removeContribution(p.first, p.second);
+            ++nbRemoved;
+        }
     }
 
+    manifest = std::move(newManifest);
 
-    return true;
-}
-
-bool MacroLoader::importFromFolder(const std::string& folderpath, const Options& config)
-{
-    if(importDirectory(folderpath.c_str(), *this, config)){
+    if(firstImport)
         this->addOrigin(folderpath);
-        return true;
-    }
-    return false;
+    else
+        std::cout << "Files since the last import: " << nbAdded << " added, " << nbModified << " modified, " << nbRemoved << " removed, " << nbUnchanged << " unchanged." << std::endl;
+
+    return true;
 }
 
 bool importProjectFile(const std::string& filepath, MacroContainer& macroContainer)
@@ -1,9 +1,49 @@
 #ifndef MACROLOADER_HPP
 #define MACROLOADER_HPP
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
 #include "container.hpp"
 #include "macrosearch.hpp"
 
+/**< definitions read from files, in the order they were read (the names and the values are pooled strings). */
+typedef std::vector< std::pair<const std::string*, const std::string*> > DefinitionList;
+
+/**< what is remembered about a file imported from a folder, to know if it has to be parsed again on the next import. */
+struct FileRecord
+{
+    /**< the last modification time of the file when it was parsed. */
+    long long modificationTime;
+    /**< the size of the file when it was parsed. */
+    unsigned long long size;
+    /**< the hash of the content of the file when it was parsed. */
+    std::uint64_t hash;
+    /**< the macros the file brought to the macrospace. */
+    DefinitionList macros;
+};
+
+/**< how a macro of the database comes from the files of the folders imported. */
+struct FolderContribution
+{
+    /**< the number of files defining it. */
+    unsigned nbFiles;
+    /**< true if it was also defined another way (define, importfile, load..), it is kept when no file defines it anymore. */
+    bool pinned;
+};
+
+/**< hash of a pooled name and a pooled value: two pooled strings are equal only if they have the same address. */
+struct ContributionHash
+{
+    inline std::size_t operator()(const std::pair<const std::string*, const std::string*>& p) const
+    {
+        return std::hash<const std::string*>()(p.first) * 31 + std::hash<const std::string*>()(p.second);
+    }
+};
+
 // This class enables the capability of loading macros from files and folders from a Macrospace.
 // Specifically, it contains the implementation related to it.
 
@@ -23,8 +63,41 @@ public:
      * \param folderpath the folder path.
      * \param config the list of options (preprocessor instructions interpretation enabled ?)
      * \return false if the directory could not be opened or if there is no file inside it, otherwise true if at least one file was listed.
+     *
+     * When the folder was already imported, only the files that were added, modified or removed since are taken into account.
      */
     bool importFromFolder(const std::string& folderpath, const Options& config);
+
+    /** \brief list the pooled strings the database refers to, including the macros remembered for the folders imported.
+     *
+     * \param used the addresses of the strings are added to this set.
+     */
+    void listPooledStrings(std::unordered_set<const std::string*>& used) const;
+
+protected:
+    /** \brief a definition stored another way than by the import of a folder is pinned, if a folder also brought it.
+     */
+    void definitionStored(const std::string* macroName, const std::string* macroValue) override;
+
+    /** \brief once definitions are deleted another way than by the import of a folder, the folders imported are forgotten:
+     *         their next import parses every file again, so that the definitions deleted come back.
+     */
+    void definitionsRemoved() override;
+
+private:
+    /** \brief add a macro coming from a file of a folder (pooled name and value).
+     */
+    void addContribution(const std::string* macroName, const std::string* macroValue);
+
+    /** \brief remove a macro coming from a file of a folder, the macro is erased once no file defines it anymore
+     *         (unless it was also defined another way).
+     */
+    void removeContribution(const std::string* macroName, const std::string* macroValue);
+
+    /**< for each folder imported, the files that were parsed (indexed by their path). */
+    std::unordered_map< std::string, std::unordered_map<std::string, FileRecord> > manifests;
+    /**< the macros defined by the files of the folders (indexed by their pooled name and value). */
+    std::unordered_map< std::pair<const std::string*, const std::string*>, FolderContribution, ContributionHash > contributions;
 };
 
 
@@ -139,10 +139,23 @@ bool directoryExists(const char* szPath)
   return (dwAttrib != INVALID_FILE_ATTRIBUTES && (dwAttrib & FILE_ATTRIBUTE_DIRECTORY));
 }
 
+bool getFileStatus(const char* pathToFile, long long& modificationTime, unsigned long long& size)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if(!GetFileAttributesExA(pathToFile, GetFileExInfoStandard, &data))
+        return false;
+
+    modificationTime = (static_cast<long long>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    return true;
+}
+
 #else
 
 #include <dirent.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 
 void explore_directory(std::string basepath, std::vector<std::string>& vec)
 {
@@ -185,4 +198,21 @@ bool directoryExists(const char* basepath)
     return isOpen;
 }
 
+bool getFileStatus(const char* pathToFile, long long& modificationTime, unsigned long long& size)
+{
+    struct stat fileStat;
+
+    if(stat(pathToFile, &fileStat) != 0)
+        return false;
+
+    // Nanoseconds are needed to notice two modifications made during the same second
+#if defined(__APPLE__)
+    modificationTime = static_cast<long long>(fileStat.st_mtimespec.tv_sec)*1000000000 + fileStat.st_mtimespec.tv_nsec;
+#else
+    modificationTime = static_cast<long long>(fileStat.st_mtim.tv_sec)*1000000000 + fileStat.st_mtim.tv_nsec;
+#endif
+    size = static_cast<unsigned long long>(fileStat.st_size);
+    return true;
+}
+
 #endif
@@ -54,5 +54,14 @@ void explore_directory(std::string dirname, std::vector<std::string>& files);
  */
 bool directoryExists(const char* basepath);
 
+/** \brief get the last modification time and the size of a file.
+ *
+ * \param pathToFile the path to the file.
+ * \param modificationTime the last modification time, in a unit that depends on the operating system.
+ * \param size the size of the file in bytes.
+ * \return true if the operating system could give the information, false otherwise.
+ */
+bool getFileStatus(const char* pathToFile, long long& modificationTime, unsigned long long& size);
+
 
 #endif // MACROSEARCH_HPP
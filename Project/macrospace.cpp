@@ -20,16 +20,24 @@
 #include <iostream>
 
 #include "macrospace.hpp"
+#include "stringpool.hpp"
+
+#define MACROSPACES_MIN_STRINGS_RELEASED 4096 /**< below that, releasing the strings is not worth listing them all. */
 
 Macrospaces::Macrospaces()
-: macrospaces()
+: msallSources(), msallRemovalRevision(0), nbStringsKept(0), removalsReleased(0), indexes(), macrospaces()
 {
     updateMsAll();
 }
 
 void Macrospaces::addMacroSpace(const std::string& macrospaceName, const MacroLoader& macrospace)
 {
-    macrospaces.emplace_back(macrospaceName, macrospace);
+    auto found = indexes.find(macrospaceName);
+
+    if(found != indexes.end())
+        found->second->second = macrospace;
+    else
+        indexes.emplace(macrospaceName, macrospaces.emplace(macrospaces.end(), macrospaceName, macrospace));
 
     if(macrospaceName=="msall")
         updateMsAll();
@@ -40,26 +48,27 @@ MacroLoader& Macrospaces::getMacroSpace(const std::string& macrospaceName)
     if(macrospaceName=="msall")
         updateMsAll();
 
-    for(auto& p: macrospaces){
-        if(p.first == macrospaceName)
-            return p.second;
-    }
+    auto found = indexes.find(macrospaceName);
+    if(found != indexes.end())
+        return found->second->second;
 
-    macrospaces.emplace_back(macrospaceName, MacroLoader());
-    MacroLoader* kkk=nullptr;
-    for(auto& p: macrospaces)
-        kkk = &(p.second);
-    return *kkk;
+    // The new macrospace is built in place, the other ones don't move
+    auto created = macrospaces.emplace(macrospaces.end(), macrospaceName, MacroLoader());
+    indexes.emplace(macrospaceName, created);
+    return created->second;
 }
 
-bool Macrospaces::doesMacrospaceExists(const std::string& macrospaceName)
+MacroLoader& Macrospaces::deriveMacroSpace(const std::string& parentName, const std::string& childName)
 {
-    for(const auto& p: macrospaces){
-        if(p.first == macrospaceName)
-            return true;
-    }
+    const MacroLoader& parent = getMacroSpace(parentName);
+    MacroLoader& child = getMacroSpace(childName);
+    child.setParent(&parent);
+    return child;
+}
 
-    return false;
+bool Macrospaces::doesMacrospaceExists(const std::string& macrospaceName)
+{
+    return indexes.find(macrospaceName) != indexes.end();
 }
 
 MacroLoader* Macrospaces::tryGetMacroSpace(const std::string& macroSpaceName)
@@ -67,28 +76,75 @@ MacroLoader* Macrospaces::tryGetMacroSpace(const std::string& macroSpaceName)
     if(macroSpaceName=="msall")
         updateMsAll();
 
-    for(auto& p: macrospaces){
-        if(p.first == macroSpaceName)
-            return &(p.second);
-    }
+    auto found = indexes.find(macroSpaceName);
+    if(found != indexes.end())
+        return &(found->second->second);
+    return nullptr;
+}
+
+const MacroLoader* Macrospaces::findMacroSpace(const std::string& macrospaceName) const
+{
+    auto found = indexes.find(macrospaceName);
+    if(found != indexes.end())
+        return &(found->second->second);
     return nullptr;
 }
 
 void Macrospaces::deleteMacroSpace(const std::string& macroSpaceName)
 {
-    for(auto it=macrospaces.begin(); it!=macrospaces.end();++it){
-        if(it->first == macroSpaceName){
-            macrospaces.erase(it);
-            return;
+    auto found = indexes.find(macroSpaceName);
+    if(found != indexes.end()){
+        const MacroLoader* deleted = &(found->second->second);
+
+        // The macrospaces derived from it can't rely on it anymore
+        for(auto& p: macrospaces){
+            if(p.second.getParent() == deleted)
+                p.second.flatten();
         }
+
+        macrospaces.erase(found->second);
+        indexes.erase(found);
+
+        releaseUnusedStrings(true);
+    }
+}
+
+void Macrospaces::releaseUnusedStrings(bool always)
+{
+    // The strings only become useless when macros are removed or replaced
+    unsigned long long removals = 0;
+    for(const auto& p: macrospaces){
+        if(p.first != "msall")
+            removals += p.second.getRemovalRevision();
     }
+
+    if(!always && (removals == removalsReleased || StringPool::size() < 2*nbStringsKept + MACROSPACES_MIN_STRINGS_RELEASED))
+        return;
+
+    // msall must not keep the macros removed from the other macrospaces
+    updateMsAll();
+
+    std::unordered_set<const std::string*> used;
+    for(const auto& p: macrospaces)
+        p.second.listPooledStrings(used);
+
+    StringPool::compact(used);
+    nbStringsKept = StringPool::size();
+    removalsReleased = removals;
 }
 
 void Macrospaces::printContentToUser()
 {
     updateMsAll();
     for(const auto& p: macrospaces){
-            std::cout << "- " << p.first << " => " << p.second.getDefines().size() << " macros." << std::endl;
+            std::cout << "- " << p.first << " => " << p.second.getDefines().size() << " macros.";
+
+            for(const auto& other: macrospaces){
+                if(&other.second == p.second.getParent())
+                    std::cout << " (derived from " << other.first << ')';
+            }
+
+            std::cout << std::endl;
     }
 }
 
@@ -100,21 +156,69 @@ std::size_t Macrospaces::size() const
 void Macrospaces::updateMsAll()
 {
     MacroLoader *mc=nullptr;
-    for(auto& p: macrospaces){
+    auto found = indexes.find("msall");
+
+    if(found != indexes.end())
+        mc = &(found->second->second);
+    else {
+        auto created = macrospaces.emplace(macrospaces.end(), "msall", MacroLoader());
+        indexes.emplace("msall", created);
+        mc = &(created->second);
+
+        // Nothing was merged into this new msall
+        msallSources.clear();
+        msallRemovalRevision = mc->getRemovalRevision();
+    }
+
+    // Let's compare the macrospaces with the ones msall was built from
+    std::vector<MsAllSource> sources;
+    std::vector<const MacroLoader*> toBeMerged;
+    bool rebuild = (mc->getRemovalRevision() != msallRemovalRevision);
+
+    for(auto& p : macrospaces)
+    {
         if(p.first == "msall")
-            mc = &(p.second);
+            continue;
+
+        const MacroLoader& space = p.second;
+        sources.push_back({ p.first, space.getRevision(), space.getRemovalRevision() });
+
+        auto previous = msallSources.begin();
+        while(previous != msallSources.end() && previous->name != p.first)
+            ++previous;
+
+        if(previous == msallSources.end() || previous->revision != space.getRevision())
+            toBeMerged.push_back(&space);
+
+        // Macros were removed from it, they have to be removed from msall too
+        if(previous != msallSources.end() && previous->removalRevision != space.getRemovalRevision())
+            rebuild = true;
     }
 
-    if(!mc){
-        macrospaces.emplace_back("msall", MacroLoader());
-        mc = &(macrospaces[macrospaces.size()-1].second);
+    // A macrospace was deleted
+    for(const MsAllSource& previous: msallSources)
+    {
+        bool found = false;
+        for(const MsAllSource& source: sources)
+            found = found || (source.name == previous.name);
+        rebuild = rebuild || !found;
     }
 
-    for(auto& p : macrospaces)
+    if(rebuild)
     {
-        if(p.first != "msall")
-        {
-            mc->import(p.second);
+        mc->clearDatabase(true, false, false);
+
+        toBeMerged.clear();
+        for(auto& p : macrospaces){
+            if(p.first != "msall")
+                toBeMerged.push_back(&p.second);
         }
     }
+
+    // The macrospaces that only grew are merged again, the macros already there are skipped by emplace
+    for(const MacroLoader* space: toBeMerged)
+        mc->import(*space);
+
+    msallSources = std::move(sources);
+    msallRemovalRevision = mc->getRemovalRevision();
 }
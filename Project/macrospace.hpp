@@ -21,6 +21,8 @@
 #define MACROSPACE_HPP
 
 #include <vector>
+#include <list>
+#include <unordered_map>
 
 #include "macroloader.hpp" // contains MacroLoader class
 #include "container.hpp" // contains MacroContainer class
@@ -33,7 +35,7 @@ public:
      */
     Macrospaces();
 
-    /** \brief add a macrospace to this big database.
+    /** \brief add a macrospace to this big database (if a macrospace already has this name, its content is replaced).
      *
      * \param macrospaceName the macrospace name attached to it.
      * \param macrospace the macrospace we want to add.
@@ -41,6 +43,7 @@ public:
     void addMacroSpace(const std::string& macrospaceName, const MacroLoader& macrospace);
 
     /** \brief obtain a macrospace from the database by its name. If it does not exists, it automatically creates an empty one with the name provided.
+     *         The reference stays valid until the macrospace is deleted, even if other macrospaces are created.
      *
      * \return the existing macrospace, or the new empty macrospace that has just been created.
      */
@@ -53,9 +56,36 @@ public:
     bool doesMacrospaceExists(const std::string& macrospaceName);
 
 
+    /** \brief create a macrospace overlaying another one: it only stores the macros added, replaced or removed afterwards,
+     *         the other macros are looked for in the parent macrospace.
+     *
+     * \param parentName the name of the existing macrospace to be overlaid.
+     * \param childName the name of the new macrospace (it must not exist yet).
+     * \return the new macrospace.
+     */
+    MacroLoader& deriveMacroSpace(const std::string& parentName, const std::string& childName);
+
     MacroLoader* tryGetMacroSpace(const std::string& macrospaceName);
+
+    /** \brief obtain a macrospace by its name without changing anything (msall is not updated), several threads can call it at the same time.
+     *
+     * \return the macrospace, nullptr if it does not exist.
+     */
+    const MacroLoader* findMacroSpace(const std::string& macrospaceName) const;
+
+    /** \brief delete a macrospace, the macrospaces derived from it get a copy of the macros they inherited.
+     *         The strings only it referred to are released.
+     */
     void deleteMacroSpace(const std::string& macrospaceName);
 
+    /** \brief release the pooled strings no macrospace refers to anymore (see StringPool). It must be called when no other
+     *         thread uses the macrospaces, and when nothing else keeps pooled strings (the pool is shared by the whole program).
+     *
+     * \param always false to do it only if macros were removed and the pool doubled since the last time (so that the work done
+     *        stays proportional to the strings added), true to do it now (after macros were cleared for instance).
+     */
+    void releaseUnusedStrings(bool always);
+
     /** \brief show the list of all macrospaces and their content to the end user, using std::cout.
      */
     void printContentToUser();
@@ -66,12 +96,34 @@ public:
 
 private:
     /** \brief update the msall macrospace. It is the macrospace that regroup all the macrospaces reunited.
+     *         Only the macrospaces that changed since the last update are merged again, nothing is done if none changed.
      */
     void updateMsAll();
 
+    /**< a macrospace merged into msall, with the revisions it had at that time. */
+    struct MsAllSource
+    {
+        std::string name;
+        unsigned long long revision;
+        unsigned long long removalRevision;
+    };
+
+    /**< the macrospaces msall was built from. */
+    std::vector<MsAllSource> msallSources;
+    /**< the removal revision of msall after its last update (if macros were removed from msall itself, it has to be built again). */
+    unsigned long long msallRemovalRevision;
+    /**< the number of strings left in the pool after the last time the unused ones were released. */
+    std::size_t nbStringsKept;
+    /**< the sum of the removal revisions of the macrospaces at that time. */
+    unsigned long long removalsReleased;
+
+    /**< the position of each macrospace in the list, by name. */
+    std::unordered_map< std::string, std::list< std::pair<std::string, MacroLoader> >::iterator > indexes;
+
 public:
-    /**< the database containing all the macrospaces */
-    std::vector< std::pair<std::string, MacroLoader> > macrospaces;
+    /**< the database containing all the macrospaces, in the order they were created.
+         It is a list so that creating a macrospace never moves the other ones. */
+    std::list< std::pair<std::string, MacroLoader> > macrospaces;
 };
 
 
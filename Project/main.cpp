@@ -19,17 +19,165 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
+#include <utility>
 
 #include "literals.hpp"
 #include "stringeval.hpp"
 #include "command.hpp"
 #include "options.hpp"
+#include "batch.hpp"
+#include "server.hpp"
 
 
+/**< the exit codes of the command line mode. */
+enum CommandLineExitCode { EXIT_ALL_EVALUATED = 0, EXIT_INCORRECT_CALL = 1, EXIT_EVALUATION_FAILED = 2 };
 
+static void printCommandLineUsage()
+{
+    std::cerr << "usage: MacroParser [--script file] [--command cmd] [--space macrospace] [--eval expr] [--json] [--output file] [--serve socket] [macro/pattern/@file..]\n";
+    std::cerr << "- --script file : run a script (to import the macros for instance), the scripts and commands are run in order\n";
+    std::cerr << "- --command cmd : run a single command, like 'importfolder path'\n";
+    std::cerr << "- --space macrospace : the macrospace in which the macros are evaluated (default by default)\n";
+    std::cerr << "- --eval expr : evaluate a macro or an expression, as it is\n";
+    std::cerr << "- macro/pattern/@file : evaluate macros by name, by glob pattern (GPIO*_BASE) or listed in a file\n";
+    std::cerr << "- --json/--csv : format of the rows written to the standard output (csv by default): name, value, hexa, status\n";
+    std::cerr << "- --output file : write the rows to a file instead of the standard output\n";
+    std::cerr << "- --serve socket : once the scripts and commands are run, serve the requests sent to a Unix domain socket (see server.hpp)\n";
+    std::cerr << "The messages of the commands are written to the error output. boot.txt is not run, the config file is not modified.\n";
+    std::cerr << "Exit codes: 0 = every value was computed, 1 = incorrect call or missing file/macrospace, 2 = at least one value could not be computed." << std::endl;
+}
+
+/** \brief run the program without any prompt, from the arguments of the command line.
+ *         The rows of the evaluations are the only thing written to the standard output.
+ *
+ * \return the exit code of the program.
+ */
+static int runCommandLine(int argc, char* argv[])
+{
+    // The scripts and commands to run, in order (true for a script)
+    std::vector< std::pair<bool, std::string> > steps;
+    std::vector<std::string> patterns;
+    std::string macrospaceName = "default", outputPath, socketPath;
+    BatchFormat format = BatchFormat::CSV;
+
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = (i+1 < argc);
+
+        if(arg == "--json")
+            format = BatchFormat::JSON;
+        else if(arg == "--csv")
+            format = BatchFormat::CSV;
+        else if(arg == "--help"){
+            printCommandLineUsage();
+            return EXIT_ALL_EVALUATED;
+        }
+        else if(arg == "--batch")
+            {} // the evaluations are always done in batch
+        else if(arg == "--script" && hasValue)
+            steps.emplace_back(true, argv[++i]);
+        else if(arg == "--command" && hasValue)
+            steps.emplace_back(false, argv[++i]);
+        else if(arg == "--space" && hasValue)
+            macrospaceName = argv[++i];
+        else if(arg == "--eval" && hasValue)
+            patterns.push_back('=' + std::string(argv[++i]));
+        else if(arg == "--output" && hasValue)
+            outputPath = argv[++i];
+        else if(arg == "--serve" && hasValue && isServerAvailable())
+            socketPath = argv[++i];
+        else if(arg.compare(0, 2, "--") == 0){
+            printCommandLineUsage();
+            return EXIT_INCORRECT_CALL;
+        }
+        else
+            patterns.push_back(arg);
+    }
+
+    // Something has to be done, and the macros of a server are given by its requests
+    if((steps.empty() && patterns.empty() && socketPath.empty()) || (!socketPath.empty() && !patterns.empty())){
+        printCommandLineUsage();
+        return EXIT_INCORRECT_CALL;
+    }
+
+    std::ofstream file;
+    if(!outputPath.empty())
+    {
+        file.open(outputPath);
+        if(!file){
+            std::cerr << "Error: the file '" << outputPath << "' can't be written." << std::endl;
+            return EXIT_INCORRECT_CALL;
+        }
+    }
+
+    // The messages of the commands go to the error output, the standard output only receives the rows
+    std::ostream rows(outputPath.empty() ? std::cout.rdbuf() : file.rdbuf());
+    std::streambuf* messages = std::cerr.rdbuf();
+    std::cout.rdbuf(messages);
+    std::cout << std::boolalpha;
+
+    // Nobody is there to answer questions, and the config file is left as it is
+    Options options;
+    options.setPersistent(false);
+
+    CommandManager cmd(options);
+    cmd.setInteractive(false);
 
-int main()
+    for(const auto& step: steps)
+    {
+        if(!step.first)
+        {
+            cmd.runCommand(step.second);
+            continue;
+        }
+
+        const bool found = cmd.loadScript(step.second);
+
+        // The scripts end their messages without line break
+        std::cout << std::endl;
+
+        if(!found){
+            std::cerr << "Error: the script '" << step.second << "' can't be opened." << std::endl;
+            return EXIT_INCORRECT_CALL;
+        }
+    }
+
+    if(!socketPath.empty())
+        return runEvaluationServer(cmd, socketPath) ? EXIT_ALL_EVALUATED : EXIT_INCORRECT_CALL;
+
+    if(patterns.empty())
+        return EXIT_ALL_EVALUATED;
+
+    std::size_t nbFailed = 0;
+    if(!cmd.runBatch(macrospaceName, patterns, format, rows, nbFailed))
+        return EXIT_INCORRECT_CALL;
+
+    if(nbFailed > 0){
+        std::cerr << nbFailed << " values could not be computed." << std::endl;
+        return EXIT_EVALUATION_FAILED;
+    }
+
+    return EXIT_ALL_EVALUATED;
+}
+
+int main(int argc, char* argv[])
 {
+    // Any argument means that the program is used by another one, nothing is asked
+    if(argc >= 2)
+    {
+        try {
+            return runCommandLine(argc, argv);
+        }
+        catch(std::exception const& ex)
+        {
+            std::cerr << "Fatal exception: " << ex.what() << std::endl;
+            return EXIT_INCORRECT_CALL;
+        }
+    }
+
     // Welcoming message
     std::cout << "WELCOME TO MACRO PARSER.\n";
     std::cout << "Type 'help' to see the available commands.\n" << std::endl;
@@ -19,6 +19,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <cctype>
 
 #include "options.hpp"
 #include "container.hpp"
@@ -28,6 +29,7 @@
 #include "strings.hpp"
 
 Options::Options()
+: persistent(true)
 {
     resetToDefault();
     loadFromFile(OPTIONS_FILENAME);
@@ -42,6 +44,7 @@ void Options::resetToDefault()
     printExprAtEveryStep = false;
     keepListRedefinedMacros = true;
     disableInterpretations = false;
+    nbThreads = 0;
 }
 
 
@@ -79,6 +82,10 @@ bool Options::loadFromFile(const char* filename)
             {
                 loadBooleanValue(line.substr(23), disableInterpretations);
             }
+            else if(line.substr(0,10) == "nbThreads=")
+            {
+                loadUnsignedValue(line.substr(10), nbThreads);
+            }
             else
             {
                 std::cout << "/!\\ Warning: Unrecognized option name '" << line << "' in the config file. /!\\\n" << std::endl;
@@ -113,6 +120,25 @@ bool Options::loadBooleanValue(std::string input, bool& booleanValue)
     return false;
 }
 
+bool Options::loadUnsignedValue(std::string input, unsigned& value)
+{
+    clearSpaces(input);
+
+    bool isNumber = (!input.empty() && input.size() <= 4);
+    for(char c: input){
+        if(!isdigit(c))
+            isNumber = false;
+    }
+
+    if(isNumber){
+        value = static_cast<unsigned>(std::stoul(input));
+        return true;
+    }
+
+    std::cout << "/!\\ Warning: Unrecognized number '" << input << "' for the option /!\\" << std::endl;
+    return false;
+}
+
 void Options::toStream(std::ostream& stream) const
 {
     stream << "importOnlySourceFileExtension=" << importOnlySourceFileExtension << std::endl;
@@ -121,12 +147,16 @@ void Options::toStream(std::ostream& stream) const
     stream << "printExprAtEveryStep=" << printExprAtEveryStep << std::endl;
     stream << "keepListRedefinedMacros=" << keepListRedefinedMacros << std::endl;
     stream << "disableInterpretations=" << disableInterpretations << std::endl;
+    stream << "nbThreads=" << nbThreads << std::endl;
 }
 
 
 
 bool Options::saveToFile(const char* filename) const
 {
+    if(!persistent)
+        return false;
+
     std::ofstream file(filename);
 
     if(!file)
@@ -145,6 +175,14 @@ bool Options::changeOption(std::string s1, std::string& s2)
     lowerString(s1);
     lowerString(s2);
 
+    // The number of threads is the only option that is not a boolean value
+    if(isRoughlyEqualTo("nbthreads", s1)){
+        if(!loadUnsignedValue(s2, nbThreads))
+            return false;
+        saveToFile(OPTIONS_FILENAME);
+        return true;
+    }
+
     // Interpret s2
     if(s2=="1"||isRoughlyEqualTo("true",s2)){
         valueToBeSet=true;
@@ -217,3 +255,8 @@ bool Options::doDisableInterpretations() const
 {
     return disableInterpretations;
 }
+
+unsigned Options::getNbThreads() const
+{
+    return nbThreads;
+}
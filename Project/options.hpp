@@ -44,6 +44,12 @@ public:
      */
     bool changeOption(std::string s1, std::string& s2);
 
+    /** \brief choose if the changes of the options are saved to the config file (true by default).
+     *
+     * \param enabled false to keep the changes in memory only.
+     */
+    inline void setPersistent(bool enabled) { persistent = enabled; }
+
     // Getters, get the value of the options.
     bool doesImportOnlySourceFileExtension() const;
     bool doesImportMacroCommented() const;
@@ -51,6 +57,7 @@ public:
     bool doesPrintExprAtEveryStep() const;
     bool doKeepListRedefinedMacros() const;
     bool doDisableInterpretations() const;
+    unsigned getNbThreads() const;
 
 private:
     /** \brief saves the configuration to a given file name.
@@ -73,6 +80,14 @@ private:
      */
     static bool loadBooleanValue(std::string input, bool& boolean);
 
+    /** \brief convert a string to an unsigned value when possible.
+     *
+     * \param input the string to be converted to an unsigned value.
+     * \param value a variable, that will contain the value of the conversion if it is possible.
+     * \return true if the conversion occured successfully, false otherwise.
+     */
+    static bool loadUnsignedValue(std::string input, unsigned& value);
+
     /** \brief reset the configuration to the default configuration.
      */
     void resetToDefault();
@@ -84,6 +99,8 @@ private:
     bool printExprAtEveryStep;
     bool keepListRedefinedMacros;
     bool disableInterpretations;
+    unsigned nbThreads; // number of threads used to import a folder (0 = as many as the hardware supports)
+    bool persistent; // are the changes saved to the config file ?
 };
 
 
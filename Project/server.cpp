@@ -0,0 +1,782 @@
+/**
+  ******************************************************************************
+  * @file    server.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include <system_error>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+
+#include "server.hpp"
+#include "batch.hpp"
+#include "strings.hpp"
+
+#if !(defined(_WIN32) || defined(_WIN64))
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#define SERVER_MAX_REQUEST_SIZE (16*1024*1024) /**< a longer line is not a request, the connection is closed. */
+#define SERVER_MAX_PENDING_CONNECTIONS 64 /**< the connections waiting to be accepted. */
+#define SERVER_MAX_CLIENTS 32 /**< the clients served at the same time (one thread each), the connections above it are refused. */
+#define SERVER_STOP_TIMEOUT_SECONDS 10 /**< the time given to the requests running when the server stops. */
+
+/**< a request sent by a client. */
+struct ServerRequest
+{
+    /**< the id of the request, as it was written (JSON text), null if there is none. */
+    std::string id = "null";
+    std::string command;
+    std::string space = "default";
+    std::string expr;
+    std::string args;
+    std::vector<std::string> macros;
+};
+
+/**< reads the JSON object of a request, the values that are not needed are skipped. */
+class RequestReader
+{
+public:
+    explicit RequestReader(const std::string& line)
+    : text(line), position(0)
+    {}
+
+    /** \brief read the whole request.
+     *
+     * \return false if the line is not a correct JSON object.
+     */
+    bool read(ServerRequest& request)
+    {
+        if(!consume('{'))
+            return false;
+
+        if(consume('}'))
+            return atEnd();
+
+        do
+        {
+            std::string key;
+            if(!readString(key) || !consume(':'))
+                return false;
+
+            bool correct;
+            if(key == "id")
+                correct = readRaw(request.id);
+            else if(key == "command")
+                correct = readString(request.command);
+            else if(key == "space")
+                correct = readString(request.space);
+            else if(key == "expr")
+                correct = readString(request.expr);
+            else if(key == "args")
+                correct = readString(request.args);
+            else if(key == "macros")
+                correct = readStringArray(request.macros);
+            else
+                correct = skipValue();
+
+            if(!correct)
+                return false;
+        }
+        while(consume(','));
+
+        return consume('}') && atEnd();
+    }
+
+private:
+    void skipSpaces()
+    {
+        while(position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r' || text[position] == '\n'))
+            ++position;
+    }
+
+    bool consume(char c)
+    {
+        skipSpaces();
+        if(position >= text.size() || text[position] != c)
+            return false;
+        ++position;
+        return true;
+    }
+
+    bool atEnd()
+    {
+        skipSpaces();
+        return position == text.size();
+    }
+
+    /** \brief add a character given by its code, the ones below 256 are latin-1 characters like the source files (UTF-8 otherwise).
+     */
+    static void appendCodePoint(std::string& str, unsigned code)
+    {
+        if(code < 0x100)
+            str += static_cast<char>(code);
+        else if(code < 0x800){
+            str += static_cast<char>(0xC0 | (code >> 6));
+            str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else {
+            str += static_cast<char>(0xE0 | (code >> 12));
+            str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool readString(std::string& str)
+    {
+        if(!consume('"'))
+            return false;
+
+        str.clear();
+
+        while(position < text.size())
+        {
+            const char c = text[position++];
+
+            if(c == '"')
+                return true;
+            else if(c != '\\')
+                str += c;
+            else if(position >= text.size())
+                return false;
+            else
+            {
+                const char escaped = text[position++];
+                switch(escaped)
+                {
+                    case '"': case '\\': case '/': str += escaped; break;
+                    case 'b': str += '\b'; break;
+                    case 'f': str += '\f'; break;
+                    case 'n': str += '\n'; break;
+                    case 'r': str += '\r'; break;
+                    case 't': str += '\t'; break;
+
+                    case 'u':
+                    {
+                        if(position+4 > text.size())
+                            return false;
+
+                        unsigned code = 0;
+                        for(int i=0; i<4; ++i)
+                        {
+                            const char h = text[position++];
+                            code <<= 4;
+                            if(h >= '0' && h <= '9') code += h-'0';
+                            else if(h >= 'a' && h <= 'f') code += h-'a'+10;
+                            else if(h >= 'A' && h <= 'F') code += h-'A'+10;
+                            else return false;
+                        }
+                        appendCodePoint(str, code);
+                        break;
+                    }
+
+                    default: return false;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool readStringArray(std::vector<std::string>& strings)
+    {
+        if(!consume('['))
+            return false;
+
+        if(consume(']'))
+            return true;
+
+        do
+        {
+            strings.emplace_back();
+            if(!readString(strings.back()))
+                return false;
+        }
+        while(consume(','));
+
+        return consume(']');
+    }
+
+    /** \brief read any value and keep its JSON text.
+     */
+    bool readRaw(std::string& raw)
+    {
+        skipSpaces();
+        const std::size_t start = position;
+
+        if(!skipValue())
+            return false;
+
+        raw = text.substr(start, position-start);
+        return true;
+    }
+
+    bool skipValue()
+    {
+        skipSpaces();
+        if(position >= text.size())
+            return false;
+
+        const char c = text[position];
+        std::string ignored;
+
+        if(c == '"')
+            return readString(ignored);
+
+        if(c == '[' || c == '{')
+        {
+            const char closing = (c == '[' ? ']' : '}');
+            ++position;
+
+            if(consume(closing))
+                return true;
+
+            do
+            {
+                if(c == '{' && (!readString(ignored) || !consume(':')))
+                    return false;
+                if(!skipValue())
+                    return false;
+            }
+            while(consume(','));
+
+            return consume(closing);
+        }
+
+        // A number, true, false or null
+        const std::size_t start = position;
+        while(position < text.size() && (isalnum(static_cast<unsigned char>(text[position])) || text[position] == '-' || text[position] == '+' || text[position] == '.'))
+            ++position;
+
+        return position > start;
+    }
+
+    const std::string& text;
+    std::size_t position;
+};
+
+/**< a lock taken by many readers at the same time, or by a single writer.
+     The writers waiting go first, so that an import is never delayed by a flow of evaluations. */
+class ReadWriteLock
+{
+public:
+    ReadWriteLock()
+    : mutex(), released(), nbReaders(0), nbWritersWaiting(0), writing(false)
+    {}
+
+    void lockShared()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [this]{ return !writing && nbWritersWaiting == 0; });
+        ++nbReaders;
+    }
+
+    void unlockShared()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--nbReaders == 0)
+            released.notify_all();
+    }
+
+    void lock()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++nbWritersWaiting;
+        released.wait(lock, [this]{ return !writing && nbReaders == 0; });
+        --nbWritersWaiting;
+        writing = true;
+    }
+
+    void unlock()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writing = false;
+        released.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    unsigned nbReaders;
+    unsigned nbWritersWaiting;
+    bool writing;
+};
+
+/**< holds a ReadWriteLock as a reader while it exists. */
+class SharedLock
+{
+public:
+    explicit SharedLock(ReadWriteLock& rwlock) : lock(rwlock) { lock.lockShared(); }
+    ~SharedLock() { lock.unlockShared(); }
+
+private:
+    SharedLock(const SharedLock&) = delete;
+    SharedLock& operator=(const SharedLock&) = delete;
+
+    ReadWriteLock& lock;
+};
+
+/** \brief run a command of the console, and get the text it printed.
+ */
+static std::string runAndCaptureOutput(CommandManager& commandManager, const std::string& commandLine)
+{
+    std::ostringstream output;
+    output << std::boolalpha;
+
+    std::streambuf* previous = std::cout.rdbuf(output.rdbuf());
+
+    try
+    {
+        commandManager.runCommand(commandLine);
+    }
+    catch(...)
+    {
+        std::cout.rdbuf(previous);
+        throw;
+    }
+
+    std::cout.rdbuf(previous);
+    return output.str();
+}
+
+/** \brief get the options used to read the macrospaces: the same as the program, but nothing is printed during evaluations.
+ */
+static Options makeReadingOptions(const Options& configuration)
+{
+    Options options = configuration;
+    options.setPersistent(false);
+
+    std::string disabled = "0";
+    options.changeOption("printreplacements", disabled);
+    disabled = "0";
+    options.changeOption("printexprateverystep", disabled);
+
+    return options;
+}
+
+/**< the state of the server, shared by the threads of the connections. */
+class EvaluationServer
+{
+public:
+    EvaluationServer(CommandManager& manager, const std::string& path)
+    : commandManager(manager), socketPath(path), spacesLock(), outputMutex(), readingOptions(makeReadingOptions(manager.getConfiguration())),
+      stopping(false), clientsMutex(), clientsEnded(), clients()
+    {}
+
+    /** \brief answer a request.
+     *
+     * \param line the request (a JSON object).
+     * \return the response (a JSON object, without line break).
+     */
+    std::string answer(const std::string& line)
+    {
+        ServerRequest request;
+        std::ostringstream response;
+
+        if(!RequestReader(line).read(request)){
+            response << "{\"id\":null,\"ok\":false,\"error\":\"the request is not a correct JSON object.\"}";
+            return response.str();
+        }
+
+        response << "{\"id\":" << request.id << ',';
+        lowerString(request.command);
+
+        try
+        {
+            if(request.command == "look" || request.command == "evaluate")
+                answerEvaluation(request, response);
+            else if(request.command == "spacediff")
+                answerSpaceDiff(request, response);
+            else if(request.command == "shutdown")
+            {
+                stopping = true;
+                wakeUpListener();
+                response << "\"ok\":true}";
+            }
+            else if(request.command.empty() || request.command == "exit" || request.command == "loadscript")
+            {
+                response << "\"ok\":false,\"error\":";
+                writeJsonString(response, "the command '" + request.command + "' can't be run by the server.");
+                response << '}';
+            }
+            else
+                answerCommand(request, response);
+        }
+        catch(const std::exception& ex)
+        {
+            response.str(std::string());
+            response << "{\"id\":" << request.id << ",\"ok\":false,\"error\":";
+            writeJsonString(response, std::string("exception: ") + ex.what());
+            response << '}';
+        }
+
+        return response.str();
+    }
+
+    /** \brief evaluate macros or an expression, at the same time as the other readers.
+     */
+    void answerEvaluation(const ServerRequest& request, std::ostream& response)
+    {
+        std::vector<std::string> patterns = request.macros;
+        if(request.command == "evaluate")
+            patterns.assign(1, '=' + request.expr);
+
+        SharedLock lock(spacesLock);
+
+        const MacroContainer* mc = commandManager.findMacroSpace(request.space);
+        if(!mc){
+            response << "\"ok\":false,\"error\":";
+            writeJsonString(response, "the macrospace '" + request.space + "' does not exist.");
+            response << '}';
+            return;
+        }
+
+        std::vector<std::string> names;
+        std::string missingFile;
+        if(!expandBatchNames(*mc, patterns, names, missingFile)){
+            response << "\"ok\":false,\"error\":";
+            writeJsonString(response, "the file '" + missingFile + "' can't be opened.");
+            response << '}';
+            return;
+        }
+
+        std::ostringstream rows;
+        const std::size_t nbFailed = evaluateBatch(*mc, names, readingOptions, BatchFormat::JSON, rows);
+
+        // The rows are written on a single line
+        std::string text = rows.str();
+        text.erase(std::remove(text.begin(), text.end(), '\n'), text.end());
+
+        response << "\"ok\":true,\"failed\":" << nbFailed << ",\"rows\":" << text << '}';
+    }
+
+    /** \brief compare macrospaces, at the same time as the readers (the text printed is captured, so one at a time).
+     */
+    void answerSpaceDiff(const ServerRequest& request, std::ostream& response)
+    {
+        SharedLock lock(spacesLock);
+        std::lock_guard<std::mutex> outputLock(outputMutex);
+
+        const std::string output = runAndCaptureOutput(commandManager, "spacediff " + request.args);
+
+        response << "\"ok\":true,\"output\":";
+        writeJsonString(response, output);
+        response << '}';
+    }
+
+    /** \brief run any other command, alone since it may change the macrospaces.
+     */
+    void answerCommand(const ServerRequest& request, std::ostream& response)
+    {
+        std::string output;
+
+        spacesLock.lock();
+        try
+        {
+            output = runAndCaptureOutput(commandManager, request.command + ' ' + request.args);
+
+            // The readers must find msall as it is now, and the options that may have changed
+            commandManager.synchronizeMacroSpaces();
+            readingOptions = makeReadingOptions(commandManager.getConfiguration());
+        }
+        catch(...)
+        {
+            spacesLock.unlock();
+            throw;
+        }
+        spacesLock.unlock();
+
+        response << "\"ok\":true,\"output\":";
+        writeJsonString(response, output);
+        response << '}';
+    }
+
+#if !(defined(_WIN32) || defined(_WIN64))
+
+    /** \brief accept the connections until a shutdown request.
+     *
+     * \return false if the socket could not be created.
+     */
+    bool run()
+    {
+        // The messages of the server go to the error output, std::cout is captured by the commands
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if(socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)){
+            std::cerr << "Error: the socket path '" << socketPath << "' is empty or too long." << std::endl;
+            return false;
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size()+1);
+
+        // A client leaving before its response is written must not stop the server
+        std::signal(SIGPIPE, SIG_IGN);
+
+        const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listener < 0){
+            std::cerr << "Error: the socket can't be created (" << std::strerror(errno) << ")." << std::endl;
+            return false;
+        }
+
+        // Only a socket left by a server that stopped can be replaced
+        struct stat status;
+        if(lstat(socketPath.c_str(), &status) == 0)
+        {
+            if(!S_ISSOCK(status.st_mode)){
+                std::cerr << "Error: the socket '" << socketPath << "' can't be opened (" << std::strerror(EADDRINUSE) << ", it is not a socket)." << std::endl;
+                close(listener);
+                return false;
+            }
+
+            const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            const bool served = (probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+            if(probe >= 0)
+                close(probe);
+
+            if(served){
+                std::cerr << "Error: the socket '" << socketPath << "' is already served by another process." << std::endl;
+                close(listener);
+                return false;
+            }
+
+            unlink(socketPath.c_str());
+        }
+
+        if(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SERVER_MAX_PENDING_CONNECTIONS) != 0){
+            std::cerr << "Error: the socket '" << socketPath << "' can't be opened (" << std::strerror(errno) << ")." << std::endl;
+            close(listener);
+            return false;
+        }
+
+        std::cerr << "Serving the requests on " << socketPath << '.' << std::endl;
+
+        while(!stopping)
+        {
+            const int client = accept(listener, nullptr, nullptr);
+
+            if(client < 0)
+            {
+                if(errno == EINTR || errno == ECONNABORTED)
+                    continue;
+
+                std::cerr << "Error: the connections can't be accepted anymore (" << std::strerror(errno) << ")." << std::endl;
+                break;
+            }
+
+            // The connection that woke the listener up is not a client
+            if(stopping){
+                close(client);
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(clientsMutex);
+
+            if(clients.size() < SERVER_MAX_CLIENTS)
+            {
+                clients.insert(client);
+
+                try {
+                    std::thread(&EvaluationServer::serveClient, this, client).detach();
+                    continue;
+                }
+                catch(const std::system_error&){
+                    clients.erase(client);
+                }
+            }
+            lock.unlock();
+
+            sendAll(client, "{\"id\":null,\"ok\":false,\"error\":\"too many clients are connected, try again later.\"}\n");
+            close(client);
+        }
+
+        close(listener);
+        unlink(socketPath.c_str());
+
+        // The clients still connected get the responses of their current requests, then they are disconnected
+        std::unique_lock<std::mutex> lock(clientsMutex);
+        for(int client: clients)
+            shutdown(client, SHUT_RD);
+
+        if(!clientsEnded.wait_for(lock, std::chrono::seconds(SERVER_STOP_TIMEOUT_SECONDS), [this]{ return clients.empty(); }))
+        {
+            // Their threads still use the server and the macrospaces, the program ends without waiting for them
+            std::cerr << "The server stopped, " << clients.size() << " requests that did not end were abandoned." << std::endl;
+            std::_Exit(EXIT_SUCCESS);
+        }
+
+        std::cerr << "The server stopped." << std::endl;
+        return true;
+    }
+
+private:
+    /** \brief answer the requests of a client until it disconnects.
+     */
+    void serveClient(int client)
+    {
+        std::string pending;
+        char buffer[65536];
+        bool connected = true;
+
+        while(connected && !stopping)
+        {
+            const ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+
+            if(received < 0 && errno == EINTR)
+                continue;
+            if(received <= 0)
+                break;
+
+            pending.append(buffer, static_cast<std::size_t>(received));
+
+            // Each complete line is a request
+            std::size_t start = 0, end;
+            while(connected && (end = pending.find('\n', start)) != std::string::npos)
+            {
+                std::string line = pending.substr(start, end-start);
+                start = end+1;
+
+                if(!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if(line.find_first_not_of(" \t") == std::string::npos)
+                    continue;
+
+                connected = sendAll(client, answer(line) + '\n');
+            }
+            pending.erase(0, start);
+
+            if(pending.size() > SERVER_MAX_REQUEST_SIZE){
+                sendAll(client, "{\"id\":null,\"ok\":false,\"error\":\"the request is too long.\"}\n");
+                break;
+            }
+        }
+
+        close(client);
+
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clients.erase(client);
+        clientsEnded.notify_all();
+    }
+
+    /** \brief write a whole response to a client.
+     *
+     * \return false if the client disconnected.
+     */
+    static bool sendAll(int client, const std::string& data)
+    {
+        std::size_t sent = 0;
+
+        while(sent < data.size())
+        {
+            const ssize_t written = send(client, data.data()+sent, data.size()-sent, 0);
+
+            if(written < 0 && errno == EINTR)
+                continue;
+            if(written <= 0)
+                return false;
+
+            sent += static_cast<std::size_t>(written);
+        }
+
+        return true;
+    }
+
+    /** \brief connect to the socket, so that the listener leaves accept() and sees that the server is stopping.
+     */
+    void wakeUpListener()
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size()+1);
+
+        const int wakeUp = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(wakeUp >= 0){
+            connect(wakeUp, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            close(wakeUp);
+        }
+    }
+
+#else
+
+private:
+    void wakeUpListener()
+    {}
+
+#endif
+
+    /**< the program whose macrospaces are served. */
+    CommandManager& commandManager;
+    /**< the path of the socket file. */
+    std::string socketPath;
+    /**< taken as a reader to read the macrospaces, as a writer to run the other commands. */
+    ReadWriteLock spacesLock;
+    /**< the text printed on std::cout is captured by a single request at a time. */
+    std::mutex outputMutex;
+    /**< the options used by the evaluations (they print nothing). */
+    Options readingOptions;
+    /**< true once a shutdown request was received. */
+    std::atomic<bool> stopping;
+    /**< protects the list of clients. */
+    std::mutex clientsMutex;
+    /**< notified each time a client disconnects. */
+    std::condition_variable clientsEnded;
+    /**< the sockets of the clients connected. */
+    std::set<int> clients;
+};
+
+bool isServerAvailable()
+{
+#if !(defined(_WIN32) || defined(_WIN64))
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool runEvaluationServer(CommandManager& commandManager, const std::string& socketPath)
+{
+#if !(defined(_WIN32) || defined(_WIN64))
+    // Nobody is there to answer the questions of the commands
+    commandManager.setInteractive(false);
+    commandManager.synchronizeMacroSpaces();
+
+    EvaluationServer server(commandManager, socketPath);
+    return server.run();
+#else
+    (void) commandManager;
+    std::cerr << "Error: the server needs Unix domain sockets, it can't run on this platform (" << socketPath << ")." << std::endl;
+    return false;
+#endif
+}
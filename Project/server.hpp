@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @file    server.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+/// This file describes the evaluation server: the macrospaces stay in memory, and other programs send their requests
+/// through a local Unix domain socket. Each request and each response is a JSON object written on a single line.
+///
+/// Requests:
+///   {"id":1, "command":"look", "space":"board", "macros":["GPIOB_BASE", "RCC_*", "@names.txt"]}
+///   {"id":2, "command":"evaluate", "space":"board", "expr":"GPIOB_BASE + 0x10"}
+///   {"id":3, "command":"spacediff", "args":"default board --different"}
+///   {"id":4, "command":"importfolder", "args":"/path/to/headers board"}   (any other command of the console)
+///   {"id":5, "command":"shutdown"}
+/// Responses (the id of the request is given back as it is):
+///   {"id":1, "ok":true, "failed":0, "rows":[{"name":"GPIOB_BASE", "value":"1073873920", "hexa":"0x40020400", "status":"ok"}, ...]}
+///   {"id":3, "ok":true, "output":"the text printed by the command"}
+///   {"id":9, "ok":false, "error":"the reason"}
+///
+/// The requests look and evaluate run at the same time (each connection has its thread), spacediff runs alongside them.
+/// The other commands (imports, definitions...) change the macrospaces, so each one runs alone.
+/// A limited number of clients are served at the same time, the connections above it get an error and are closed.
+/// Once a shutdown request is received, the requests running are given a few seconds to end, then the program stops without them.
+
+#include <string>
+
+#include "command.hpp"
+
+/** \brief tell if the server can run on this platform (it needs Unix domain sockets).
+ */
+bool isServerAvailable();
+
+/** \brief serve the requests until a shutdown request is received.
+ *
+ * \param commandManager the program whose macrospaces are served.
+ * \param socketPath the path of the socket file, it replaces the socket left by a server that stopped (never any other file).
+ * \return false if the socket could not be created.
+ */
+bool runEvaluationServer(CommandManager& commandManager, const std::string& socketPath);
+
+#endif // SERVER_HPP
@@ -0,0 +1,333 @@
+/**
+  ******************************************************************************
+  * @file    snapshot.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "snapshot.hpp"
+#include "sourcefile.hpp"
+
+#define SNAPSHOT_MAGIC "MPSNAPSH" /**< the 8 characters every snapshot file starts with. */
+#define SNAPSHOT_VERSION 1 /**< to be increased each time the layout of the file changes. */
+
+/**< a string stored in the string table of the snapshot file. */
+struct SnapshotString
+{
+    const char* data;
+    std::uint32_t size;
+};
+
+/**< reads the numbers and strings of a snapshot, making sure it never goes past the end of the file. */
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char* content, std::size_t length)
+    : content(content), length(length), position(0)
+    {}
+
+    bool readNumber(std::uint32_t& value)
+    {
+        if(length-position < 4)
+            return false;
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(content+position);
+        value = static_cast<std::uint32_t>(bytes[0])
+              | static_cast<std::uint32_t>(bytes[1]) << 8
+              | static_cast<std::uint32_t>(bytes[2]) << 16
+              | static_cast<std::uint32_t>(bytes[3]) << 24;
+
+        position += 4;
+        return true;
+    }
+
+    bool readString(SnapshotString& str)
+    {
+        if(!readNumber(str.size) || length-position < str.size)
+            return false;
+
+        str.data = content+position;
+        position += str.size;
+        return true;
+    }
+
+    bool readMagic()
+    {
+        if(length < 8 || std::memcmp(content, SNAPSHOT_MAGIC, 8) != 0)
+            return false;
+
+        position = 8;
+        return true;
+    }
+
+private:
+    const char* content;
+    std::size_t length;
+    std::size_t position;
+};
+
+/** \brief append a 32-bit little endian number to the output buffer.
+ */
+static void writeNumber(std::string& output, std::uint32_t value)
+{
+    output += static_cast<char>(value & 0xFF);
+    output += static_cast<char>((value >> 8) & 0xFF);
+    output += static_cast<char>((value >> 16) & 0xFF);
+    output += static_cast<char>((value >> 24) & 0xFF);
+}
+
+/** \brief append a length-prefixed string to the output buffer.
+ */
+static void writeString(std::string& output, const std::string& str)
+{
+    writeNumber(output, static_cast<std::uint32_t>(str.size()));
+    output += str;
+}
+
+/**< the string table being built when saving a snapshot, each distinct string is stored once. */
+class StringTable
+{
+public:
+    std::uint32_t indexOf(const std::string& str)
+    {
+        auto it = indexes.find(str);
+        if(it != indexes.end())
+            return it->second;
+
+        std::uint32_t index = static_cast<std::uint32_t>(strings.size());
+        indexes.emplace(str, index);
+        strings.push_back(&str);
+        return index;
+    }
+
+    void writeTo(std::string& output) const
+    {
+        for(const std::string* str: strings)
+            writeString(output, *str);
+    }
+
+    std::uint32_t size() const
+    {
+        return static_cast<std::uint32_t>(strings.size());
+    }
+
+private:
+    std::unordered_map<std::string, std::uint32_t> indexes;
+    std::vector<const std::string*> strings;
+};
+
+bool Snapshot::save(const std::string& filepath, const std::string& macrospaceName, const MacroContainer& mc)
+{
+    StringTable table;
+    std::string definitions;
+    std::string origins;
+    std::uint32_t nbNames = 0;
+
+    // The values of a same name are next to each other in the multimap, let's group them
+    // The definitions inherited from a parent are saved too, the snapshot is a complete macrospace
+    const DefinitionsView definitionsSaved = mc.getDefines();
+    std::uint32_t nbDefinitions = 0;
+
+    auto it = definitionsSaved.begin();
+    while(it != definitionsSaved.end())
+    {
+        auto groupEnd = it;
+        std::uint32_t nbValues = 0;
+        while(groupEnd != definitionsSaved.end() && groupEnd->first == it->first){
+            ++groupEnd;
+            ++nbValues;
+        }
+
+        writeNumber(definitions, table.indexOf(it->first));
+        writeNumber(definitions, nbValues);
+        for(; it != groupEnd; ++it)
+            writeNumber(definitions, table.indexOf(it->second));
+
+        ++nbNames;
+        nbDefinitions += nbValues;
+    }
+
+    for(const std::string& origin: mc.origins)
+        writeNumber(origins, table.indexOf(origin));
+
+    // Now that the string table is complete, let's write the whole file in one go
+    std::string output(SNAPSHOT_MAGIC);
+    writeNumber(output, SNAPSHOT_VERSION);
+    writeNumber(output, table.size());
+    writeNumber(output, nbNames);
+    writeNumber(output, nbDefinitions);
+    writeNumber(output, static_cast<std::uint32_t>(mc.origins.size()));
+    writeNumber(output, mc.countRedefined());
+    writeString(output, macrospaceName);
+    table.writeTo(output);
+    output += definitions;
+    output += origins;
+
+    std::ofstream file(filepath, std::ios::binary);
+
+    if(!file)
+        return false;
+
+    file.write(output.data(), output.size());
+    return static_cast<bool>(file);
+}
+
+/** \brief read the header of a snapshot file, up to the name of the macrospace.
+ *
+ * \return true if the header is correct, false otherwise.
+ */
+static bool readHeader(SnapshotReader& reader, std::uint32_t (&counts)[5], SnapshotString& name)
+{
+    std::uint32_t version;
+
+    if(!reader.readMagic() || !reader.readNumber(version) || version != SNAPSHOT_VERSION)
+        return false;
+
+    for(std::uint32_t& count: counts){
+        if(!reader.readNumber(count))
+            return false;
+    }
+
+    return reader.readString(name);
+}
+
+bool Snapshot::readName(const std::string& filepath, std::string& macrospaceName)
+{
+    SourceFile file(filepath.c_str());
+    if(!file.is_open())
+        return false;
+
+    SnapshotReader reader(file.data(), file.size());
+    std::uint32_t counts[5];
+    SnapshotString name;
+
+    if(!readHeader(reader, counts, name))
+        return false;
+
+    macrospaceName.assign(name.data, name.size);
+    return true;
+}
+
+bool Snapshot::load(const std::string& filepath, MacroContainer& mc)
+{
+    SourceFile file(filepath.c_str());
+    if(!file.is_open())
+        return false;
+
+    SnapshotReader reader(file.data(), file.size());
+    std::uint32_t counts[5];
+    SnapshotString name;
+
+    if(!readHeader(reader, counts, name))
+        return false;
+
+    const std::uint32_t nbStrings = counts[0];
+    const std::uint32_t nbNames = counts[1];
+    const std::uint32_t nbDefinitions = counts[2];
+    const std::uint32_t nbOrigins = counts[3];
+    const std::uint32_t nbRedefined = counts[4];
+
+    // Every string takes at least 4 bytes, this prevents huge allocations with a corrupted file
+    if(nbStrings > file.size()/4)
+        return false;
+
+    std::vector<SnapshotString> strings(nbStrings);
+    for(SnapshotString& str: strings){
+        if(!reader.readString(str))
+            return false;
+    }
+
+    // Let's check the whole file before touching the macrospace
+    std::vector<std::uint32_t> indexes;
+    indexes.reserve(nbDefinitions+2*nbNames);
+
+    std::uint32_t nbRead = 0;
+    for(std::uint32_t i=0; i<nbNames; ++i)
+    {
+        std::uint32_t nameIndex, nbValues;
+        if(!reader.readNumber(nameIndex) || !reader.readNumber(nbValues) || nameIndex >= nbStrings || nbValues > nbDefinitions-nbRead)
+            return false;
+
+        indexes.push_back(nameIndex);
+        indexes.push_back(nbValues);
+
+        for(std::uint32_t j=0; j<nbValues; ++j)
+        {
+            std::uint32_t valueIndex;
+            if(!reader.readNumber(valueIndex) || valueIndex >= nbStrings)
+                return false;
+            indexes.push_back(valueIndex);
+        }
+
+        nbRead += nbValues;
+    }
+
+    std::vector<std::uint32_t> originIndexes(nbOrigins);
+    for(std::uint32_t& originIndex: originIndexes){
+        if(!reader.readNumber(originIndex) || originIndex >= nbStrings)
+            return false;
+    }
+
+    if(nbRead != nbDefinitions)
+        return false;
+
+    // Finally let's fill the macrospace
+    const bool wasEmpty = (mc.defines.empty() && !mc.parent);
+
+    if(wasEmpty)
+        mc.defines.reserve(nbNames);
+
+    for(std::size_t k=0; k<indexes.size();)
+    {
+        const SnapshotString& nameStr = strings[indexes[k]];
+        std::string macroName(nameStr.data, nameStr.size);
+        std::uint32_t nbValues = indexes[k+1];
+        k += 2;
+
+        const std::string* pooledName = StringPool::intern(macroName);
+        if(wasEmpty)
+            mc.indexName(pooledName);
+
+        for(std::uint32_t j=0; j<nbValues; ++j, ++k)
+        {
+            const SnapshotString& valueStr = strings[indexes[k]];
+
+            // The values saved are already distinct, an empty macrospace receives them directly
+            if(wasEmpty){
+                const std::string* pooledValue = StringPool::intern(std::string(valueStr.data, valueStr.size));
+                mc.defines.add(pooledName, pooledValue);
+                mc.definitionStored(pooledName, pooledValue);
+            }
+            else
+                mc.emplace(macroName, std::string(valueStr.data, valueStr.size));
+        }
+    }
+
+    if(wasEmpty){
+        mc.nbRedefined = nbRedefined;
+        mc.markChanged(false);
+    }
+
+    for(std::uint32_t originIndex: originIndexes)
+        mc.addOrigin(std::string(strings[originIndex].data, strings[originIndex].size));
+
+    return true;
+}
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file    snapshot.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <string>
+
+#include "container.hpp"
+
+/// A snapshot is a binary file containing a whole macrospace, so that it can be reloaded without parsing the source files again.
+/// Every number is stored as a 32-bit little endian value. The layout of the file is:
+/// - the header: the magic word "MPSNAPSH", the version, the number of strings, names, definitions, origins and redefined macros.
+/// - the name of the macrospace saved (length-prefixed).
+/// - the string table: every distinct name, value and origin, each one length-prefixed.
+/// - the definitions grouped by name: the index of the name, the number of values, then the indexes of the values.
+/// - the origins: the index of each origin.
+
+class Snapshot
+{
+public:
+    /** \brief save the content of a macrospace to a snapshot file.
+     *
+     * \param filepath the path to the snapshot file to be written.
+     * \param macrospaceName the name of the macrospace saved.
+     * \param mc the macrospace to be saved.
+     * \return true if the file was written, false otherwise.
+     */
+    static bool save(const std::string& filepath, const std::string& macrospaceName, const MacroContainer& mc);
+
+    /** \brief read the name of the macrospace saved in a snapshot file.
+     *
+     * \param filepath the path to the snapshot file.
+     * \param macrospaceName the name read.
+     * \return true if the file is a snapshot, false otherwise.
+     */
+    static bool readName(const std::string& filepath, std::string& macrospaceName);
+
+    /** \brief load the macros of a snapshot file into a macrospace.
+     *         If the macrospace is empty, the macros are inserted directly. Otherwise they are merged, like with an import.
+     *
+     * \param filepath the path to the snapshot file.
+     * \param mc the macrospace receiving the macros.
+     * \return true if the file was loaded, false if it could not be opened or if it is not a valid snapshot.
+     */
+    static bool load(const std::string& filepath, MacroContainer& mc);
+};
+
+#endif // SNAPSHOT_HPP
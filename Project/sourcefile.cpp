@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file    sourcefile.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <cstring>
+#include <fstream>
+
+#include "sourcefile.hpp"
+
+#if (defined(_WIN32) || defined(_WIN64))
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SourceFile::SourceFile()
+: content(nullptr), length(0), position(0), mapped(false), buffer()
+{}
+
+SourceFile::SourceFile(const char* pathToFile)
+: SourceFile()
+{
+    open(pathToFile);
+}
+
+SourceFile::~SourceFile()
+{
+    close();
+}
+
+#if (defined(_WIN32) || defined(_WIN64))
+
+/** \brief map the whole file in memory.
+ *
+ * \param pathToFile the path to the file.
+ * \param size the size of the file (0 if the file is empty).
+ * \return the address of the mapped content, nullptr if the file could not be mapped.
+ */
+static const char* mapFile(const char* pathToFile, std::size_t& size)
+{
+    HANDLE file = CreateFileA(pathToFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    const char* view = nullptr;
+    LARGE_INTEGER fileSize;
+
+    if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping)
+        {
+            view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+    }
+
+    CloseHandle(file);
+    return view;
+}
+
+static void unmapFile(const char* view, std::size_t)
+{
+    UnmapViewOfFile(view);
+}
+
+#else
+
+/** \brief map the whole file in memory.
+ *
+ * \param pathToFile the path to the file.
+ * \param size the size of the file (0 if the file is empty).
+ * \return the address of the mapped content, nullptr if the file could not be mapped.
+ */
+static const char* mapFile(const char* pathToFile, std::size_t& size)
+{
+    int fd = ::open(pathToFile, O_RDONLY);
+    if(fd < 0)
+        return nullptr;
+
+    const char* view = nullptr;
+    struct stat fileStat;
+
+    if(fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0)
+    {
+        void* address = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if(address != MAP_FAILED)
+        {
+            view = static_cast<const char*>(address);
+            size = static_cast<std::size_t>(fileStat.st_size);
+        }
+    }
+
+    ::close(fd);
+    return view;
+}
+
+static void unmapFile(const char* view, std::size_t size)
+{
+    munmap(const_cast<char*>(view), size);
+}
+
+#endif
+
+bool SourceFile::open(const char* pathToFile)
+{
+    close();
+
+    // First, let's try to map the file directly in memory
+    std::size_t mappedSize = 0;
+    const char* view = mapFile(pathToFile, mappedSize);
+
+    if(view)
+    {
+        content = view;
+        length = mappedSize;
+        mapped = true;
+        return true;
+    }
+
+    // Otherwise, let's read it in one block (empty files and special files end up here)
+    std::ifstream file(pathToFile, std::ios::binary);
+    if(!file.is_open())
+        return false;
+
+    char block[65536];
+    while(file.read(block, sizeof(block)) || file.gcount() > 0)
+        buffer.insert(buffer.end(), block, block+file.gcount());
+
+    // content must not be null, even for an empty file, so that is_open() works
+    buffer.push_back('\0');
+    content = buffer.data();
+    length = buffer.size()-1;
+    return true;
+}
+
+bool SourceFile::is_open() const
+{
+    return content != nullptr;
+}
+
+void SourceFile::close()
+{
+    if(mapped)
+        unmapFile(content, length);
+
+    content = nullptr;
+    length = 0;
+    position = 0;
+    mapped = false;
+    buffer.clear();
+}
+
+bool SourceFile::getline(std::string& line)
+{
+    line.clear();
+
+    if(position >= length)
+        return false;
+
+    std::size_t endOfLine = find('\n', position);
+    line.assign(content+position, endOfLine-position);
+
+    // the '\n' character is extracted but not stored
+    seek(endOfLine+1);
+    return true;
+}
+
+void SourceFile::skipLine()
+{
+    seek(find('\n', position)+1);
+}
+
+void SourceFile::skipPast(char first, char second)
+{
+    std::size_t searched = position;
+
+    while((searched = find(second, searched)) < length)
+    {
+        // the first character must have been read after our current position
+        if(searched > position && content[searched-1] == first)
+            break;
+        ++searched;
+    }
+
+    seek(searched+1);
+}
+
+std::size_t SourceFile::find(char character, std::size_t from) const
+{
+    if(from >= length)
+        return length;
+
+    const void* found = std::memchr(content+from, character, length-from);
+
+    if(!found)
+        return length;
+
+    return static_cast<const char*>(found) - content;
+}
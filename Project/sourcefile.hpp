@@ -0,0 +1,122 @@
+/**
+  ******************************************************************************
+  * @file    sourcefile.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef SOURCEFILE_HPP
+#define SOURCEFILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**< A source file entirely available in memory (memory-mapped when the OS allows it, read in one block otherwise).
+     It can be read character by character like a std::ifstream, and it offers fast lookups over the whole content. */
+class SourceFile
+{
+public:
+    /** \brief Default constructor. No file is opened.
+     */
+    SourceFile();
+
+    /** \brief open a file and make its whole content available.
+     *
+     * \param pathToFile the path to the file.
+     */
+    explicit SourceFile(const char* pathToFile);
+
+    /** \brief Destructor, it releases the mapping of the file.
+     */
+    ~SourceFile();
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    /** \brief open a file and make its whole content available.
+     *
+     * \param pathToFile the path to the file.
+     * \return true if the file could be opened, false otherwise.
+     */
+    bool open(const char* pathToFile);
+
+    /** \brief check if a file is currently opened.
+     */
+    bool is_open() const;
+
+    /** \brief read the next character (same behaviour as std::istream::get).
+     *
+     * \param character the character read.
+     * \return true if a character was read, false if the end of the file was reached.
+     */
+    inline bool get(char& character)
+    {
+        if(position >= length)
+            return false;
+        character = content[position++];
+        return true;
+    }
+
+    /** \brief read characters until the end of the line (same behaviour as std::getline).
+     *
+     * \param line the line read, without its '\n' character.
+     * \return true if something was read, false if the end of the file was already reached.
+     */
+    bool getline(std::string& line);
+
+    /** \brief skip every character until the end of the line (the '\n' character is skipped too).
+     */
+    void skipLine();
+
+    /** \brief skip every character until a sequence of two characters is read (the sequence is skipped too).
+     *
+     * \param first the first character of the sequence.
+     * \param second the second character of the sequence.
+     */
+    void skipPast(char first, char second);
+
+    /** \brief find the next occurrence of a character, starting from a given position.
+     *
+     * \param character the character to look for.
+     * \param from the position from which we start to look.
+     * \return the position of the character, or size() if it was not found.
+     */
+    std::size_t find(char character, std::size_t from) const;
+
+    // Getters and setters of the reading position
+    inline std::size_t tell() const { return position; }
+    inline void seek(std::size_t newPosition) { position = (newPosition < length ? newPosition : length); }
+    inline std::size_t size() const { return length; }
+    inline const char* data() const { return content; }
+
+private:
+    /** \brief release the file currently opened.
+     */
+    void close();
+
+    /**< the content of the file. */
+    const char* content;
+    /**< the size of the file. */
+    std::size_t length;
+    /**< the reading position. */
+    std::size_t position;
+    /**< true if content points to a memory-mapped area that has to be unmapped. */
+    bool mapped;
+    /**< the content of the file, when it could not be memory-mapped. */
+    std::vector<char> buffer;
+};
+
+#endif // SOURCEFILE_HPP
@@ -23,6 +23,9 @@
 #include <algorithm>
 #include <memory>
 #include <cstring>
+#include <cmath>
+#include <climits>
+#include <unordered_set>
 
 #include "stringeval.hpp"
 #include "container.hpp"
@@ -30,9 +33,14 @@
 #include "config.hpp"
 #include "vector.hpp"
 #include "strings.hpp"
+#include "tokeneval.hpp"
+#include "arithmetic.hpp"
 
 using std::string;
 
+#define STRINGEVAL_MAX_REPLACEMENTS 500 /**< the maximum number of replacements in the expression, above it the evaluation stops. */
+#define STRINGEVAL_MAX_CYCLE_SEARCH 4096 /**< the maximum number of macros explored to know if a macro leads back to itself. */
+
 static bool thereIsMacroLetter(const std::string& str)
 {
     for(unsigned i=0; i<str.size(); ++i){
@@ -66,6 +74,76 @@ static bool containsAlpha(const std::string& str)
     return false;
 }
 
+/** \brief tell if a value leads back to a macro, directly ("#define A u.A") or through the values of other macros ("#define C D.x", "#define D C.y").
+ *
+ * \param name the name of the macro, without its parameters.
+ * \param value a value of the macro.
+ */
+static bool leadsBackTo(const MacroContainer& macroContainer, const std::string& name, const std::string& value)
+{
+    const auto& dictionary = macroContainer.getDefines();
+    std::unordered_set<std::string> explored;
+    std::vector<const std::string*> pending(1, &value);
+
+    while(!pending.empty() && explored.size() < STRINGEVAL_MAX_CYCLE_SEARCH)
+    {
+        const std::string& str = *pending.back();
+        pending.pop_back();
+
+        for(std::size_t i=0; i<str.size(); )
+        {
+            if(!isMacroCharacter(str[i])){
+                ++i;
+                continue;
+            }
+
+            std::size_t start = i;
+            while(i < str.size() && isMacroCharacter(str[i]))
+                ++i;
+
+            // Numbers and their suffixes are not macros
+            if(isdigit(str[start]))
+                continue;
+
+            std::string word = str.substr(start, i-start);
+            if(word == name)
+                return true;
+
+            if(explored.insert(word).second)
+            {
+                auto range = dictionary.equal_range(word);
+                for(auto it=range.first; it!=range.second; ++it)
+                    pending.push_back(&it->second);
+            }
+        }
+    }
+
+    return false;
+}
+
+/** \brief replace every occurrence of a string, the values inserted are not searched again.
+ *
+ * \param counter the number of replacements made during the evaluation, the evaluation stops when it gets too high.
+ * \return false if there was no occurrence.
+ */
+static bool replaceEveryOccurrence(std::string& str, const std::string& from, const std::string& to, unsigned& counter)
+{
+    if(from.empty())
+        return false;
+
+    bool found = false;
+    for(std::size_t pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos+to.size()))
+    {
+        str.replace(pos, from.size(), to);
+        found = true;
+    }
+
+    if(found && ++counter > STRINGEVAL_MAX_REPLACEMENTS){
+        throw std::runtime_error("Counter pb: please post an issue on Github");
+    }
+    return found;
+}
+
 static bool containsOperation(const std::string& str)
 {
     // Let's try to calculate the arithmetic expression without parenthesis
@@ -107,9 +185,7 @@ static void func(double &result, char op, double num)
         case '%':
             if(num<=0)
                 throw std::runtime_error("modulo < 0");
-            while(result>num) {
-                result -= num;
-            }
+            result = std::fmod(result, num);
             break;
         default:
             throw std::runtime_error( std::string("Unrecognized character: ")+=op+='\n' );
@@ -150,8 +226,9 @@ static string extractLeftPart(const string& expr, size_t pos)
  * \param expr the expression.
  * \param pfirst the value of the macro.
  * \param psecond the definition of a macro.
+ * \return false if the call of the macro was not found in the expression, which is left unchanged then.
  */
-static void replaceParamMacro(string& expr, string pfirst, const string& psecond)
+static bool replaceParamMacro(string& expr, string pfirst, const string& psecond)
 {
     // Let's remove some part of each expression.
     pfirst = pfirst.substr(0, pfirst.find('('));
@@ -198,8 +275,8 @@ static void replaceParamMacro(string& expr, string pfirst, const string& psecond
     //std::cout << "popo:" << pos << std::endl;
 
 
-    if(pos == std::string::npos)
-        std::cout << "!!!!!!!!!!!!!!!" << std::endl;
+    if(maxParLevel < 0)
+        return false;
 
     // lets count ending parenthesis befor edeleting them.
 
@@ -226,12 +303,16 @@ static void replaceParamMacro(string& expr, string pfirst, const string& psecond
         }
     }
 
+    if(endingFound < 0)
+        return false;
+
     //std::cout << "1:" << expr << std::endl;
     expr.erase(pos, endingFound-pos+1);
     //std::cout << "2:" << expr << std::endl;
     expr.insert(pos, psecond);
 
     //std::cout << "expr: " << expr << std::endl;
+    return true;
 }
 
 
@@ -375,6 +456,19 @@ double evaluateSimpleArithmeticExpr(const string& expr)
     return v.front().number;
 }
 
+/** \brief compute an arithmetic expression without parentheses nor spaces, and write its value.
+ *         The integer expressions are computed exactly like the preprocessor does, the other ones with floating point values.
+ */
+static std::string calculateSimpleArithmeticExpr(const std::string& expr)
+{
+    IntegerValue value;
+
+    if(evaluateIntegerExpression(expr.data(), expr.size(), value))
+        return integerToString(value);
+
+    return std::to_string(evaluateSimpleArithmeticExpr(expr));
+}
+
 static bool treatOperationDouble(std::string& str, const std::string& operation, bool (*operateur)(double, double))
 {
     std::size_t searchedCharacter = str.find(operation);
@@ -436,7 +530,7 @@ static bool treatOperationDouble(std::string& str, const std::string& operation,
 
 
 static bool treatInterrogationOperator(std::string& expr, const MacroContainer& mc, const Options& config,
-std::vector<std::pair<std::string,std::string> >& redef)
+std::vector<std::pair<std::string,std::string> >& redef, std::vector<std::string>& expanding)
 {
     bool didSomething=false;
     std::size_t searchedInterrogation;
@@ -466,7 +560,7 @@ std::vector<std::pair<std::string,std::string> >& redef)
         std::cout << "theright: " << theright << std::endl;*/
 
         // Let's evaluate the left part
-        auto status = calculateExpression(theleft, mc, config, nullptr, true, nullptr, &redef);
+        auto status = calculateExpression(theleft, mc, config, nullptr, true, nullptr, &redef, &expanding);
 
         // If the boolean evaluation went well
         if(status == CalculationStatus::EVAL_OKAY)
@@ -530,11 +624,13 @@ std::vector<std::pair<std::string,std::string> >& redef)
  * \param enableBoolean should boolean be evaluated inside the expression ?
  * \param outputs nullptr=>1 output, it replaces expr ; !0 => multiple outputs written to outputs vector
  * \param redef if you want to replace macros contained in macroContainer during the evaluation process
+ * \param expanding the macros being expanded, they are not expanded again inside their own value (like "#define A u.A")
  * \return status
  *
  */
 enum CalculationStatus calculateExpression(string& expr, const MacroContainer& macroContainer, const Options& config,
-std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::string>* outputs, std::vector< std::pair<std::string, std::string> >* redef)
+std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::string>* outputs, std::vector< std::pair<std::string, std::string> >* redef,
+std::vector<std::string>* expanding)
 {
     CalculationStatus status = CalculationStatus::EVAL_OKAY;
 
@@ -547,8 +643,6 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
     bool thereIsOperation = false;
     bool deleteRedef = false;
 
-    locateAndReplaceEnding(expr, config);
-
     try {
 
     if(!printWarnings && !doesExprLookOk(expr)){
@@ -560,6 +654,10 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
          deleteRedef = true;
     }
 
+    std::vector<std::string> localExpanding;
+    if(!expanding)
+        expanding = &localExpanding;
+
     /// 0. Is the expression okay ?
 
     //if(expr[0] == '?')return CalculationStatus::EVAL_ERROR;
@@ -572,7 +670,18 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
         assert(expr.find(' ') == string::npos);
     #endif
 
-    removeApostrophes(expr);
+    /// Let's first try to evaluate it on tokens, it handles most expressions in a single pass
+    /// The literals are read there with their suffixes, so that unsigned values keep their type
+
+    if(enableBoolean && !config.doesPrintReplacements() && !config.doesPrintExprAtEveryStep()
+    && evaluateTokens(expr, macroContainer, redef, printWarnings))
+    {
+        if(deleteRedef) delete redef;
+        return status;
+    }
+
+    // The rest of the evaluation only deals with decimal numbers
+    normalizeLiterals(expr, config);
 
 
     /// 1. Search and replace macros
@@ -587,10 +696,10 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
 
 
         // Look for the longest word to replace
-        /// TO DO: To be replaced by a more efficient implementation.
 
-
-        std::vector<const std::pair<string,string>* > cutted;
+        std::vector<Definition> cutted;
+        std::vector<Definition> cuttedWithParameters;
+        std::vector<const std::string*> objectLikeNames, functionLikeNames;
 
         string currentWord;
         for(unsigned i=0; i<=expr.size();++i)
@@ -619,23 +728,38 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                 //std::cout << "currentWord: " << currentWord << std::endl;
 
                 /// Let's look for the word (new implementation).
-                /// The implementation could be better (we have to go through all the binary tree).
-                unsigned lk = 0;
-                for(const std::pair<std::string,std::string>& p: dictionary)
+                /// The container keeps its names sorted, the names starting with the word are next to each other.
+                objectLikeNames.clear();
+                functionLikeNames.clear();
+                macroContainer.listNamesStartingWith(currentWord, objectLikeNames, functionLikeNames);
+
+                for(const std::string* name: objectLikeNames)
                 {
-                    // if we find the occurence of the word.
-                    if(!p.first.empty() && startsWith(p.first,currentWord))
-                    {
-                        //std::cout << "pushed. first:" << p.first << " p.second:" << p.second << std::endl;
-                        cutted.push_back(&p);
-                        lk++;
+                    // A macro referring to itself is left as it is inside its value
+                    if(std::find(expanding->begin(), expanding->end(), *name) != expanding->end())
+                        continue;
+
+                    auto range = dictionary.equal_range(*name);
+                    for(auto it=range.first; it!=range.second; ++it)
+                        cutted.push_back(*it);
+                }
+
+                for(const std::string* name: functionLikeNames)
+                {
+                    if(std::find(expanding->begin(), expanding->end(), *name) != expanding->end())
+                        continue;
+
+                    auto range = dictionary.equal_range(*name);
+                    for(auto it=range.first; it!=range.second; ++it){
+                        cutted.push_back(*it);
+                        cuttedWithParameters.push_back(*it);
                     }
                 }
 
-                if(lk >= 2 && printWarnings != nullptr)
+                if(objectLikeNames.size()+functionLikeNames.size() >= 2 && !functionLikeNames.empty() && printWarnings != nullptr)
                 {
                     printWarnings->push_back(
-                    cutted.back()->first.substr(cutted.back()->first.find('(')));
+                    cutted.back().first.substr(cutted.back().first.find('(')));
                     status = CalculationStatus::EVAL_WARNING;
                 }
 
@@ -644,9 +768,8 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
         }
 
 
-        for(const std::pair<string,string>* pkpk: cutted)
+        for(const Definition& p: cutted)
         {
-            auto& p = *pkpk;
 
             const string& mac = p.first;
 
@@ -681,7 +804,7 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
         auto range = dictionary.equal_range(maxSizeReplace);
         for(auto it=range.first; it!=range.second; ++it)
         {
-            auto& p = *it;
+            const auto& p = *it;
 
             if(true/*p.first == maxSizeReplace*/ /*&& expr.find(p.first) != string::npos*/)
             {
@@ -734,7 +857,7 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                                 std::find(outputs->begin(), outputs->end(), expr) == outputs->end())
                                 {
                                     std::string anotherExpr = expr;
-                                    while(simpleReplace(anotherExpr, p.first, pp.second));
+                                    replaceEveryOccurrence(anotherExpr, p.first, pp.second, replaceCounter);
                                     //redef->emplace_back(p.first, pp.second);
 
 
@@ -753,7 +876,15 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                                         //blacklist.emplace_back(pp.first+' '+pp.second);
                                         redef->emplace_back(pp.first, pp.second);
 
-                                        auto status = calculateExpression(anotherExpr, macroContainer, config, printWarnings, enableBoolean, outputs, redef);
+                                        // The macro is not expanded again inside its own value
+                                        const bool selfReferring = leadsBackTo(macroContainer, p.first, pp.second);
+                                        if(selfReferring)
+                                            expanding->push_back(p.first);
+
+                                        auto status = calculateExpression(anotherExpr, macroContainer, config, printWarnings, enableBoolean, outputs, redef, expanding);
+
+                                        if(selfReferring)
+                                            expanding->pop_back();
                                         if(!anotherExpr.empty())
                                         {
                                             if(status == CalculationStatus::EVAL_OKAY)
@@ -799,7 +930,14 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                     }
 
                     // finally, let's replace-it in the expression
-                    simpleReplace(expr, p.first, *replacedBy);
+                    // a value leading back to the macro itself replaces every occurrence at once, the macro is not expanded anymore then
+                    if(leadsBackTo(macroContainer, p.first, *replacedBy))
+                    {
+                        replaceEveryOccurrence(expr, p.first, *replacedBy, replaceCounter);
+                        expanding->push_back(p.first);
+                    }
+                    else
+                        simpleReplace(expr, p.first, *replacedBy);
 
                     }
                 }
@@ -817,17 +955,16 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
         }
         if(!maxSizeReplaceSig.empty())
         {
-            // Look for single parameter macro
-            //auto range = dictionary.equal_range(maxSizeReplaceSig);
+            // Look for single parameter macro, among the ones whose name starts like a word of the expression
 
-            std::pair<const std::string,std::string> const* fg = nullptr;
+            const Definition* fg = nullptr;
             int maxDeep = 0;
-            int currentDeep = 0;
-            unsigned exploreWord = 0;
 
-            auto range = std::make_pair(dictionary.begin(),dictionary.end());
-            for(auto it=range.first; it!=range.second; ++it)
+            for(const Definition& it: cuttedWithParameters)
             {
+                int currentDeep = 0;
+                unsigned exploreWord = 0;
+
                 for(unsigned i=0; i<expr.size(); i++)
                 {
                     // let count how deep we are inside the parenthesis.
@@ -837,15 +974,15 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                         currentDeep--;
 
                     // lets see the expression itself.
-                    if(expr[i] == it->first[exploreWord])
+                    if(expr[i] == it.first[exploreWord])
                     {
                         exploreWord++;
-                        if(it->first[exploreWord] == '(')
+                        if(it.first[exploreWord] == '(')
                         {
                             if(!fg || currentDeep>=maxDeep)
                             {
                                 maxDeep = currentDeep;
-                                fg = &(*it);
+                                fg = &it;
                                 exploreWord = 0;
                             }
                         }
@@ -996,7 +1133,11 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
                     // Let's replace the parameterized macro with values by
                     // the parameterized macro with letters inside the expression.
                     //initialExpr = expr;
-                    replaceParamMacro(initialExpr, p.first, p.second);
+                    if(!replaceParamMacro(initialExpr, p.first, p.second))
+                    {
+                        if(deleteRedef) delete redef;
+                        return CalculationStatus::EVAL_ERROR;
+                    }
 
                     // Let's replace for each parameter.
                     string klkl = "(x)";
@@ -1007,13 +1148,15 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
 
                         // let's replace it.
                         //std::cout << "y: " << klkl << " -> " << paramValues[i] << " inside " << initialExpr << std::endl;
-                        while(simpleReplace(initialExpr, klkl, paramValues[i]));
+                        replaceEveryOccurrence(initialExpr, klkl, paramValues[i], replaceCounter);
                     }
 
                     // finally, let's replace the main expression.
                     expr = initialExpr;
 
-                    std::cout << "yes: " << initialExpr << std::endl;
+                    // The calls of the macro made by its own value are not expanded
+                    if(leadsBackTo(macroContainer, mac.substr(0, mac.find('(')), p.second))
+                        expanding->push_back(mac);
                 }
 
             }
@@ -1038,25 +1181,15 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
 
         if(!repeat)
         {
-            #ifdef READ_HEXADECIMAL
-                // Look and replace hexa
-                locateAndReplaceHexa(expr, config);
-            #endif
-            #ifdef READ_OCTAL
-                // look and replace octal values.
-                locateAndReplaceOctal(expr, config);
-            #endif // READ_OCTAL
-            #ifdef READ_BINARY
-                locateAndReplaceBinary(expr, config);
-            #endif
-            removeApostrophes(expr);
+            // Look and replace the literals of the values expanded (hexadecimal, octal, binary, suffixes...)
+            normalizeLiterals(expr, config);
         }
 
 
         clearSpaces(expr);
 
         ++replaceCounter;
-        if(replaceCounter > 500){
+        if(replaceCounter > STRINGEVAL_MAX_REPLACEMENTS){
             throw std::runtime_error("Counter pb: please post an issue on Github");
         }
     }
@@ -1118,10 +1251,8 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
 
         if(thereIsOperation)
         {
-            double value = evaluateSimpleArithmeticExpr(toBeCalculated);
-
             //std::cout << "there is op" << std::endl;
-            expr = (expr.substr(0,posOpenPar) += std::to_string(value)) += expr.substr(posClosePar+1);
+            expr = (expr.substr(0,posOpenPar) += calculateSimpleArithmeticExpr(toBeCalculated)) += expr.substr(posClosePar+1);
         }
         else
         {
@@ -1175,7 +1306,7 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
     if(containsOperation(expr) && doesExprLookOk(expr) && !containsAlpha(expr) && expr.find('(')==std::string::npos && expr.find(')')==std::string::npos)
     {
         //std::cout << "aa" << std::endl;
-        expr = std::to_string(evaluateSimpleArithmeticExpr(expr));
+        expr = calculateSimpleArithmeticExpr(expr);
         if(config.doesPrintExprAtEveryStep()){
             std::cout << expr << '.' << std::endl;
         }
@@ -1265,7 +1396,7 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
             // Let's to reevaluate what is in the parenthesis
             std::string subExpr2 = subExpr;
             //std::cout << "entry1" << std::endl;
-            auto status2 = calculateExpression(subExpr2, macroContainer, config, nullptr, enableBoolean, nullptr, redef);
+            auto status2 = calculateExpression(subExpr2, macroContainer, config, nullptr, enableBoolean, nullptr, redef, expanding);
             //std::cout << "end1" << std::endl;
             if(status2 == CalculationStatus::EVAL_OKAY
             && (begStr.empty() || !isMacroCharacter(begStr.back())))
@@ -1307,7 +1438,7 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
             repeat=true;
         }
 
-        else if(treatInterrogationOperator(subExpr, macroContainer, config, *redef))
+        else if(treatInterrogationOperator(subExpr, macroContainer, config, *redef, *expanding))
         {
             expr = begStr+subExpr+endStr;
             repeat=true;
@@ -1361,7 +1492,9 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
     {
         if(status != CalculationStatus::EVAL_ERROR)
         {
-            if(result == static_cast<double>(static_cast<int>(result)) )
+            // The integers computed exactly are already written as integers
+            if(expr.find('.') != std::string::npos && result >= INT_MIN && result <= INT_MAX
+            && result == static_cast<double>(static_cast<int>(result)) )
                 expr = std::to_string(static_cast<int>(result));
         }
     }
@@ -1393,6 +1526,26 @@ std::vector<std::string>* printWarnings, bool enableBoolean, std::vector<std::st
 
 void calculateExprWithStrOutput(string& expr, const MacroContainer& macroContainer, const Options& options, std::vector<std::pair<std::string,std::string> >* redef)
 {
+    // The same expressions are evaluated again and again when a whole macrospace is listed or compared
+    const bool useCache = !options.doesPrintReplacements() && !options.doesPrintExprAtEveryStep();
+    std::string cacheKey;
+
+    if(useCache)
+    {
+        cacheKey = expr;
+
+        if(redef)
+        {
+            for(const auto& p: *redef){
+                ((cacheKey += '\n') += p.first) += ' ';
+                cacheKey += p.second;
+            }
+        }
+
+        if(macroContainer.getEvaluationCache().find(cacheKey, expr))
+            return;
+    }
+
     std::vector<std::string> output;
                 //std::cout << "Source 3" << std::endl;
     auto status = calculateExpression(expr, macroContainer, options, nullptr, true, &output, redef);
@@ -1438,6 +1591,8 @@ void calculateExprWithStrOutput(string& expr, const MacroContainer& macroContain
 
     }
 
+    if(useCache)
+        macroContainer.getEvaluationCache().store(cacheKey, expr);
 }
 
 void listUndefinedFromExpr(std::vector<std::string>& missingMacros, const std::string& expr)
@@ -47,7 +47,7 @@ double evaluateSimpleArithmeticExpr(const std::string& expr);
 
 enum CalculationStatus calculateExpression(std::string& expr, const MacroContainer& macroContainer, const Options& config,
 std::vector<std::string>* printWarnings=nullptr, bool enableBoolean=true, std::vector<std::string>* outputs=nullptr,
-std::vector< std::pair<std::string, std::string> >* redef=nullptr);
+std::vector< std::pair<std::string, std::string> >* redef=nullptr, std::vector<std::string>* expanding=nullptr);
 
 void calculateExprWithStrOutput(std::string& expr, const MacroContainer& macroContainer,
             const Options& options, std::vector<std::pair<std::string,std::string> >* redef=nullptr);
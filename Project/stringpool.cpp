@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file    stringpool.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <mutex>
+#include <unordered_set>
+
+#include "stringpool.hpp"
+
+#define STRINGPOOL_NB_SHARDS 64 /**< the files parsed on several threads rarely wait for the same shard. */
+
+/**< a part of the pool, the strings are dealt between the shards by hash. */
+struct StringPoolShard
+{
+    std::mutex mutex;
+    /**< the nodes of an unordered_set never move, the addresses given stay valid. */
+    std::unordered_set<std::string> strings;
+};
+
+/** \brief get the shards of the pool, they are created on first use.
+ */
+static StringPoolShard* getShards()
+{
+    static StringPoolShard shards[STRINGPOOL_NB_SHARDS];
+    return shards;
+}
+
+const std::string* StringPool::intern(const std::string& str)
+{
+    const std::size_t hashed = std::hash<std::string>()(str);
+    StringPoolShard& shard = getShards()[hashed % STRINGPOOL_NB_SHARDS];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return &(*shard.strings.insert(str).first);
+}
+
+std::size_t StringPool::compact(const std::unordered_set<const std::string*>& used)
+{
+    std::size_t nbReleased = 0;
+    StringPoolShard* shards = getShards();
+
+    for(unsigned i=0; i<STRINGPOOL_NB_SHARDS; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        std::unordered_set<std::string>& strings = shards[i].strings;
+
+        for(auto it=strings.begin(); it!=strings.end(); )
+        {
+            if(used.find(&(*it)) == used.end()){
+                it = strings.erase(it);
+                ++nbReleased;
+            }
+            else
+                ++it;
+        }
+    }
+
+    return nbReleased;
+}
+
+std::size_t StringPool::size()
+{
+    std::size_t total = 0;
+    StringPoolShard* shards = getShards();
+
+    for(unsigned i=0; i<STRINGPOOL_NB_SHARDS; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        total += shards[i].strings.size();
+    }
+
+    return total;
+}
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    stringpool.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef STRINGPOOL_HPP
+#define STRINGPOOL_HPP
+
+#include <string>
+#include <functional>
+#include <unordered_set>
+#include <cstddef>
+
+/// The names and the values of the macros are stored once in the string pool, the databases only keep pointers to them.
+/// The same SDK is usually loaded in several macrospaces and merged into msall, each string is shared by all of them.
+/// Reloading the same files does not make the pool grow. The strings no database refers to anymore (values replaced,
+/// macros removed by a new import of a folder, macrospaces cleared) are released by compact(), see Macrospaces::releaseUnusedStrings().
+
+class StringPool
+{
+public:
+    /** \brief get the copy of a string stored in the pool (it is added to the pool if it is not there yet).
+     *         It can be called from several threads at the same time.
+     *
+     * \param str the string to be stored.
+     * \return the address of the pooled string, it stays valid until it is released by compact().
+     */
+    static const std::string* intern(const std::string& str);
+
+    /** \brief release the strings that are not used anymore.
+     *         No other thread may use the pool meanwhile, and every pooled string still referred to must be listed.
+     *
+     * \param used the addresses of the pooled strings that are still referred to.
+     * \return the number of strings released.
+     */
+    static std::size_t compact(const std::unordered_set<const std::string*>& used);
+
+    /** \brief get the number of distinct strings stored in the pool.
+     */
+    static std::size_t size();
+};
+
+/**< hash of a string designated by a pointer (pooled or not), by content. */
+struct PooledStringHash
+{
+    inline std::size_t operator()(const std::string* str) const { return std::hash<std::string>()(*str); }
+};
+
+/**< equality of two strings designated by pointers, by content (two pooled strings are equal only if they have the same address). */
+struct PooledStringEqual
+{
+    inline bool operator()(const std::string* a, const std::string* b) const { return a == b || *a == *b; }
+};
+
+/**< order of two strings designated by pointers, by content. */
+struct PooledStringLess
+{
+    inline bool operator()(const std::string* a, const std::string* b) const { return *a < *b; }
+};
+
+#endif // STRINGPOOL_HPP
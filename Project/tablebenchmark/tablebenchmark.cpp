@@ -0,0 +1,327 @@
+/**
+  ******************************************************************************
+  * @file    tablebenchmark.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/// A benchmark of the table of definitions (definitiontable.hpp) against the unordered_multimap it replaced, it is a program of its own, built from the folder Project:
+/// g++ -std=c++11 -O2 -pthread tablebenchmark/tablebenchmark.cpp definitiontable.cpp stringpool.cpp container.cpp macroloader.cpp macrosearch.cpp
+///     sourcefile.cpp stringeval.cpp tokeneval.cpp arithmetic.cpp literals.cpp strings.cpp options.cpp threadpool.cpp closestr.cpp -o TableBenchmark
+/// - emplace, equal_range and iteration are timed on generated names, with a few names defined twice.
+/// - the import of a folder is timed, then the definitions it gave are stored again in both structures, in the same order.
+/// Usage: TableBenchmark [--names n] [--folder path] (without a folder, a folder of generated headers is imported).
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+
+#include "../definitiontable.hpp"
+#include "../stringpool.hpp"
+#include "../macroloader.hpp"
+#include "../options.hpp"
+
+#define BENCHMARK_REPETITIONS 3 /**< each measure is repeated, the best time is kept. */
+#define BENCHMARK_ITERATION_PASSES 10 /**< the number of times the definitions are iterated (like successive 'list' commands). */
+#define BENCHMARK_REDEFINED_PERCENT 5 /**< the percentage of the names having a second value. */
+#define BENCHMARK_GENERATED_FILES 2000 /**< the number of headers of the generated folder. */
+#define BENCHMARK_GENERATED_MACROS_PER_FILE 100 /**< the number of macros of each generated header. */
+
+/**< the definitions before the table: a node per definition, the names and the values are pooled strings. */
+typedef std::unordered_multimap< const std::string*, const std::string*, PooledStringHash, PooledStringEqual > MultimapDefinitions;
+
+/** \brief add a definition to the multimap the way MacroContainer did (a value already there is skipped, the values of a name are kept in order).
+ */
+static void addToMultimap(MultimapDefinitions& defines, const std::string* name, const std::string* value)
+{
+    auto range = defines.equal_range(name);
+    auto last = defines.end();
+
+    for(auto it=range.first; it!=range.second; ++it)
+    {
+        if(value == it->second)
+            return;
+        last = it;
+    }
+
+    defines.emplace_hint(last, name, value);
+}
+
+/** \brief time a function, the best of a few runs.
+ *
+ * \return the time in milliseconds.
+ */
+template<typename Function>
+static double measure(Function function)
+{
+    double best = 0.0;
+
+    for(unsigned i=0; i<BENCHMARK_REPETITIONS; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+
+        if(i == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+static void printRow(const std::string& operation, double multimapTime, double tableTime)
+{
+    std::cout << operation << ": multimap " << static_cast<long>(multimapTime+0.5) << " ms, table "
+              << static_cast<long>(tableTime+0.5) << " ms." << std::endl;
+}
+
+/** \brief time emplace, equal_range and iteration on both structures.
+ *
+ * \param definitions the pooled definitions, in the order they are added.
+ * \param lookups the names looked for (not pooled, they are compared by content).
+ */
+static void benchmarkOperations(const std::vector< std::pair<const std::string*, const std::string*> >& definitions,
+                                const std::vector<std::string>& lookups)
+{
+    volatile std::size_t sink = 0;
+
+    // The multimap was created with 50000 buckets by each MacroContainer
+    const double multimapEmplace = measure([&](){
+        MultimapDefinitions defines;
+        defines.reserve(50000);
+        for(const auto& p: definitions)
+            addToMultimap(defines, p.first, p.second);
+        sink = sink + defines.size();
+    });
+
+    const double tableEmplace = measure([&](){
+        DefinitionTable defines;
+        for(const auto& p: definitions)
+            defines.add(p.first, p.second);
+        sink = sink + defines.size();
+    });
+
+    printRow("emplace", multimapEmplace, tableEmplace);
+
+    MultimapDefinitions multimap;
+    multimap.reserve(50000);
+    DefinitionTable table;
+    for(const auto& p: definitions){
+        addToMultimap(multimap, p.first, p.second);
+        table.add(p.first, p.second);
+    }
+
+    const double multimapLookup = measure([&](){
+        for(const std::string& name: lookups)
+        {
+            auto range = multimap.equal_range(&name);
+            for(auto it=range.first; it!=range.second; ++it)
+                sink = sink + it->second->size();
+        }
+    });
+
+    const double tableLookup = measure([&](){
+        for(const std::string& name: lookups)
+        {
+            const DefinitionTable::Entry* entry = table.find(name);
+            if(entry){
+                for(const std::string* value: *entry)
+                    sink = sink + value->size();
+            }
+        }
+    });
+
+    printRow("equal_range", multimapLookup, tableLookup);
+
+    const double multimapIteration = measure([&](){
+        for(unsigned pass=0; pass<BENCHMARK_ITERATION_PASSES; ++pass){
+            for(const auto& p: multimap)
+                sink = sink + p.first->size() + p.second->size();
+        }
+    });
+
+    const double tableIteration = measure([&](){
+        for(unsigned pass=0; pass<BENCHMARK_ITERATION_PASSES; ++pass){
+            for(const DefinitionTable::Entry& entry: table){
+                for(const std::string* value: entry)
+                    sink = sink + entry.name()->size() + value->size();
+            }
+        }
+    });
+
+    printRow("iteration x" + std::to_string(BENCHMARK_ITERATION_PASSES), multimapIteration, tableIteration);
+}
+
+/** \brief generate names and values, a few names get a second value.
+ */
+static void generateDefinitions(std::size_t nbNames, std::vector< std::pair<const std::string*, const std::string*> >& definitions,
+                                std::vector<std::string>& lookups)
+{
+    std::mt19937_64 random(1);
+
+    for(std::size_t i=0; i<nbNames; ++i)
+    {
+        std::ostringstream name, value;
+        name << "PERIPH" << (random() % 1000) << "_REG" << i << "_Msk";
+        value << "(0x" << std::hex << (random() & 0xFFFFFFFFu) << "UL << " << std::dec << (random() % 32) << ')';
+
+        const std::string* pooledName = StringPool::intern(name.str());
+        definitions.emplace_back(pooledName, StringPool::intern(value.str()));
+
+        if(random() % 100 < BENCHMARK_REDEFINED_PERCENT)
+            definitions.emplace_back(pooledName, StringPool::intern(value.str() + "+1"));
+
+        lookups.push_back(name.str());
+    }
+
+    // The names are looked for in another order, and a few of them are not there
+    std::shuffle(lookups.begin(), lookups.end(), random);
+    for(std::size_t i=0; i<lookups.size(); i+=10)
+        lookups[i] += "_X";
+}
+
+/** \brief write a folder of headers to be imported.
+ */
+static bool generateFolder(const std::string& folder)
+{
+    if(std::system(("mkdir -p " + folder).c_str()) != 0)
+        return false;
+
+    std::size_t n = 0;
+    for(unsigned f=0; f<BENCHMARK_GENERATED_FILES; ++f)
+    {
+        std::ofstream file(folder + "/periph" + std::to_string(f) + ".h");
+        if(!file)
+            return false;
+
+        file << "#ifndef PERIPH" << f << "_H\n#define PERIPH" << f << "_H\n";
+        for(unsigned m=0; m<BENCHMARK_GENERATED_MACROS_PER_FILE; ++m, ++n)
+            file << "#define PERIPH" << f << "_REG" << m << "_Pos (" << (m % 32) << "U)\n"
+                 << "#define PERIPH" << f << "_REG" << m << "_Msk (0x1UL << PERIPH" << f << "_REG" << m << "_Pos)\n";
+        file << "#endif\n";
+    }
+
+    return true;
+}
+
+/** \brief time the import of a folder, then store its definitions again in both structures.
+ */
+static bool benchmarkImport(const std::string& folder)
+{
+    Options config;
+
+    double importTime = 0.0;
+    std::vector< std::pair<const std::string*, const std::string*> > definitions;
+
+    for(unsigned i=0; i<BENCHMARK_REPETITIONS; ++i)
+    {
+        MacroLoader loader;
+
+        auto start = std::chrono::steady_clock::now();
+        if(!loader.importFromFolder(folder, config))
+            return false;
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+
+        if(i == 0 || elapsed < importTime)
+            importTime = elapsed;
+
+        if(i == 0){
+            for(const auto& p: loader.getDefines())
+                definitions.emplace_back(&p.first, &p.second);
+        }
+    }
+
+    std::cout << "import of " << folder << ": " << definitions.size() << " definitions, "
+              << static_cast<long>(importTime+0.5) << " ms (table)." << std::endl;
+
+    // The files are parsed the same way with both structures, only the definitions are stored differently
+    volatile std::size_t sink = 0;
+
+    const double multimapStore = measure([&](){
+        MultimapDefinitions defines;
+        defines.reserve(50000);
+        for(const auto& p: definitions)
+            addToMultimap(defines, p.first, p.second);
+        sink = sink + defines.size();
+    });
+
+    const double tableStore = measure([&](){
+        DefinitionTable defines;
+        for(const auto& p: definitions)
+            defines.add(p.first, p.second);
+        sink = sink + defines.size();
+    });
+
+    printRow("storing the definitions imported", multimapStore, tableStore);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t nbNames = 200000;
+    std::string folder;
+
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if(arg == "--names" && i+1 < argc)
+            nbNames = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if(arg == "--folder" && i+1 < argc)
+            folder = argv[++i];
+        else {
+            std::cerr << "usage: TableBenchmark [--names n] [--folder path]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector< std::pair<const std::string*, const std::string*> > definitions;
+    std::vector<std::string> lookups;
+    generateDefinitions(nbNames, definitions, lookups);
+
+    std::cout << nbNames << " names, " << definitions.size() << " definitions." << std::endl;
+    benchmarkOperations(definitions, lookups);
+
+    const bool generated = folder.empty();
+    if(generated)
+    {
+        folder = "tablebenchmark_folder";
+        if(!generateFolder(folder)){
+            std::cerr << "Error: the folder '" << folder << "' can't be written." << std::endl;
+            return 1;
+        }
+    }
+
+    const bool imported = benchmarkImport(folder);
+
+    if(generated)
+        std::system(("rm -rf " + folder).c_str());
+
+    if(!imported){
+        std::cerr << "Error: the folder '" << folder << "' can't be imported." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    threadpool.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <exception>
+
+#include "threadpool.hpp"
+
+/**< a queue of task indexes owned by one worker, other workers may steal from it. */
+class WorkQueue
+{
+public:
+    /** \brief add a task index to the queue (only used before the workers are started).
+     */
+    void push(std::size_t index)
+    {
+        tasks.push_back(index);
+    }
+
+    /** \brief the owner of the queue takes the next task from the front.
+     *
+     * \param index the index of the task taken.
+     * \return true if a task was taken, false if the queue is empty.
+     */
+    bool pop(std::size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(tasks.empty())
+            return false;
+        index = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+    /** \brief another worker steals a task from the back.
+     *
+     * \param index the index of the task stolen.
+     * \return true if a task was stolen, false if the queue is empty.
+     */
+    bool steal(std::size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(tasks.empty())
+            return false;
+        index = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;
+};
+
+unsigned resolveThreadCount(unsigned requested)
+{
+    if(requested == 0)
+        requested = std::thread::hardware_concurrency();
+
+    // hardware_concurrency() may return 0 when it is not computable
+    if(requested == 0)
+        requested = 1;
+
+    return requested;
+}
+
+void parallelFor(std::size_t count, unsigned nbThreads, const std::function<void(std::size_t)>& task)
+{
+    if(nbThreads > count)
+        nbThreads = static_cast<unsigned>(count);
+
+    // No need to start threads, let's run everything here in order
+    if(nbThreads <= 1)
+    {
+        for(std::size_t i=0; i<count; ++i)
+            task(i);
+        return;
+    }
+
+    // Let's deal the indexes round-robin between the workers
+    std::vector< std::unique_ptr<WorkQueue> > queues;
+    for(unsigned w=0; w<nbThreads; ++w)
+        queues.emplace_back(new WorkQueue());
+    for(std::size_t i=0; i<count; ++i)
+        queues[i % nbThreads]->push(i);
+
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+
+    auto worker = [&](unsigned self)
+    {
+        std::size_t index;
+
+        while(true)
+        {
+            bool found = queues[self]->pop(index);
+
+            // Our queue is empty, let's try to steal from the others
+            for(unsigned k=1; k<nbThreads && !found; ++k)
+                found = queues[(self+k) % nbThreads]->steal(index);
+
+            // No task is left anywhere (no task is added once started)
+            if(!found)
+                break;
+
+            try
+            {
+                task(index);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!firstError)
+                    firstError = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned w=1; w<nbThreads; ++w)
+        threads.emplace_back(worker, w);
+
+    // The calling thread works too
+    worker(0);
+
+    for(std::thread& th: threads)
+        th.join();
+
+    if(firstError)
+        std::rethrow_exception(firstError);
+}
+
+void orderedParallelFor(std::size_t count, unsigned nbThreads, std::size_t window,
+                        const std::function<void(std::size_t)>& produce, const std::function<void(std::size_t)>& consume)
+{
+    if(nbThreads > count)
+        nbThreads = static_cast<unsigned>(count);
+
+    if(window < 1)
+        window = 1;
+
+    // No need to start threads, let's run everything here in order
+    // The results are produced by batches of the size of the window, it keeps the data used by each function in cache
+    if(nbThreads <= 1)
+    {
+        for(std::size_t first=0; first<count; first+=window)
+        {
+            const std::size_t last = (count-first > window ? first+window : count);
+
+            for(std::size_t i=first; i<last; ++i)
+                produce(i);
+            for(std::size_t i=first; i<last; ++i)
+                consume(i);
+        }
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable windowMoved;
+    std::size_t nextToTake = 0;
+    std::size_t nextToConsume = 0;
+    std::vector<bool> produced(count, false);
+    bool consuming = false;
+    std::exception_ptr firstError;
+
+    auto keepError = [&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!firstError)
+            firstError = std::current_exception();
+    };
+
+    auto worker = [&]()
+    {
+        while(true)
+        {
+            std::size_t index;
+
+            // The indexes are taken in increasing order, the next one to be consumed is always being produced
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                windowMoved.wait(lock, [&]{ return nextToTake >= count || nextToTake < nextToConsume+window; });
+
+                if(nextToTake >= count)
+                    break;
+
+                index = nextToTake++;
+            }
+
+            try
+            {
+                produce(index);
+            }
+            catch(...)
+            {
+                keepError();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            produced[index] = true;
+
+            // Another worker is already consuming, it will take this index too when its turn comes
+            if(consuming)
+                continue;
+
+            consuming = true;
+
+            while(nextToConsume < count && produced[nextToConsume])
+            {
+                std::size_t toConsume = nextToConsume;
+
+                // The other workers can go on producing meanwhile
+                lock.unlock();
+                try
+                {
+                    consume(toConsume);
+                }
+                catch(...)
+                {
+                    keepError();
+                }
+                lock.lock();
+
+                ++nextToConsume;
+                windowMoved.notify_all();
+            }
+
+            consuming = false;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned w=1; w<nbThreads; ++w)
+        threads.emplace_back(worker);
+
+    // The calling thread works too
+    worker();
+
+    for(std::thread& th: threads)
+        th.join();
+
+    if(firstError)
+        std::rethrow_exception(firstError);
+}
@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @file    threadpool.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+/// This file contains a small work-stealing pool used to spread independent tasks over several threads.
+
+#include <cstddef>
+#include <functional>
+
+/** \brief get the number of worker threads to be used.
+ *
+ * \param requested the number of threads asked by the user (0 means as many as the hardware supports).
+ * \return the number of threads that should be started (always at least 1).
+ */
+unsigned resolveThreadCount(unsigned requested);
+
+/** \brief run task(i) for every index i in [0, count) using nbThreads worker threads.
+ *         Each worker owns a queue of indexes, when it runs out of work it steals indexes from the others.
+ *         Indexes are dealt round-robin, so that low indexes are processed first.
+ *
+ * \param count the number of tasks to run.
+ * \param nbThreads the number of worker threads (1 runs every task on the calling thread, in order).
+ * \param task the function to be called for each index. If it throws, the first exception is rethrown once all workers stopped.
+ */
+void parallelFor(std::size_t count, unsigned nbThreads, const std::function<void(std::size_t)>& task);
+
+/** \brief run produce(i) for every index i in [0, count) using nbThreads worker threads, and consume(i) in the order of the indexes,
+ *         as soon as produce(i) and every consume before it are done. The workers take the indexes in increasing order.
+ *
+ * \param count the number of tasks to run.
+ * \param nbThreads the number of worker threads (1 runs produce(i) then consume(i) on the calling thread, in order).
+ * \param window the maximum number of indexes produced but not consumed yet, the workers wait when it is reached.
+ * \param produce the function computing the result of an index, it can be called by several threads at the same time.
+ * \param consume the function using the result of an index, it is never called by two threads at the same time.
+ *        If one of the functions throws, the first exception is rethrown once all workers stopped (the other indexes are still processed).
+ */
+void orderedParallelFor(std::size_t count, unsigned nbThreads, std::size_t window,
+                        const std::function<void(std::size_t)>& produce, const std::function<void(std::size_t)>& consume);
+
+#endif // THREADPOOL_HPP
@@ -0,0 +1,634 @@
+/**
+  ******************************************************************************
+  * @file    tokeneval.cpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+#include "tokeneval.hpp"
+#include "arithmetic.hpp"
+#include "vector.hpp"
+
+#define TOKENEVAL_MAX_DEPTH 256 /**< the maximum number of macros being expanded inside each other. */
+#define TOKENEVAL_MAX_TOKENS 65536 /**< the maximum number of tokens an expression can be expanded to. */
+
+enum class TokenType { NUMBER, BOOLEAN, IDENTIFIER, OPERATOR };
+
+enum class Operator { NONE, OPEN_PAR, CLOSE_PAR, COMMA, QUESTION, COLON,
+                      PLUS, MINUS, MULTIPLY, DIVIDE, MODULO, SHIFT_LEFT, SHIFT_RIGHT,
+                      LESS, GREATER, LESS_EQUAL, GREATER_EQUAL, EQUAL, NOT_EQUAL,
+                      BIT_AND, BIT_XOR, BIT_OR, LOGICAL_AND, LOGICAL_OR, LOGICAL_NOT, BIT_NOT };
+
+/**< a token of an expression, identifiers point to the string they were read from. */
+struct Token
+{
+    TokenType type;
+    Operator op;
+    const char* text;
+    std::size_t length;
+    IntegerValue value;
+};
+
+/**< the value of an expression (or of a part of it), either an integer or a boolean. */
+struct Value
+{
+    IntegerValue number;
+    bool isBoolean;
+};
+
+/** \brief recognize the operator at the beginning of a string.
+ *
+ * \param length the number of characters of the operator found.
+ * \return the operator, Operator::NONE if it is not an operator we can evaluate.
+ */
+static Operator readOperator(const char* str, std::size_t size, std::size_t& length)
+{
+    length = 2;
+
+    if(size >= 2)
+    {
+        switch(str[0])
+        {
+            case '<': if(str[1]=='<') return Operator::SHIFT_LEFT; if(str[1]=='=') return Operator::LESS_EQUAL; break;
+            case '>': if(str[1]=='>') return Operator::SHIFT_RIGHT; if(str[1]=='=') return Operator::GREATER_EQUAL; break;
+            case '=': if(str[1]=='=') return Operator::EQUAL; break;
+            case '!': if(str[1]=='=') return Operator::NOT_EQUAL; break;
+            case '&': if(str[1]=='&') return Operator::LOGICAL_AND; break;
+            case '|': if(str[1]=='|') return Operator::LOGICAL_OR; break;
+            default: break;
+        }
+
+        // The operators that we don't handle ('<<=', '->', '++'...) must not be read as two operators
+        if((str[0]=='-' && (str[1]=='>' || str[1]=='-' || str[1]=='='))
+        || (str[0]=='+' && (str[1]=='+' || str[1]=='=')))
+            return Operator::NONE;
+    }
+
+    length = 1;
+
+    switch(str[0])
+    {
+        case '(': return Operator::OPEN_PAR;
+        case ')': return Operator::CLOSE_PAR;
+        case ',': return Operator::COMMA;
+        case '?': return Operator::QUESTION;
+        case ':': return Operator::COLON;
+        case '+': return Operator::PLUS;
+        case '-': return Operator::MINUS;
+        case '*': return Operator::MULTIPLY;
+        case '/': return Operator::DIVIDE;
+        case '%': return Operator::MODULO;
+        case '<': return Operator::LESS;
+        case '>': return Operator::GREATER;
+        case '&': return Operator::BIT_AND;
+        case '^': return Operator::BIT_XOR;
+        case '|': return Operator::BIT_OR;
+        case '!': return Operator::LOGICAL_NOT;
+        case '~': return Operator::BIT_NOT;
+        default: return Operator::NONE;
+    }
+}
+
+/** \brief split a string into tokens.
+ *
+ * \return false if the string contains something we can't evaluate (strings, floating point values, '#'...).
+ */
+static bool tokenize(const char* str, std::size_t size, std::vector<Token>& tokens)
+{
+    std::size_t i = 0;
+
+    while(i < size)
+    {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+        Token token = { TokenType::NUMBER, Operator::NONE, str+i, 1, { 0, false } };
+
+        if(isspace(c)){
+            ++i;
+            continue;
+        }
+        else if(isalpha(c) || c == '_')
+        {
+            while(token.length < size-i && (isalnum(static_cast<unsigned char>(str[i+token.length])) || str[i+token.length] == '_'))
+                ++token.length;
+
+            token.type = TokenType::IDENTIFIER;
+        }
+        else if(isdigit(c))
+        {
+            // Let's take every character that may belong to the literal, readIntegerLiteral() rejects the wrong ones
+            while(token.length < size-i && (isalnum(static_cast<unsigned char>(str[i+token.length]))
+            || str[i+token.length] == '_' || str[i+token.length] == '\'' || str[i+token.length] == '.'))
+                ++token.length;
+
+            if(!readIntegerLiteral(str+i, token.length, token.value))
+                return false;
+        }
+        else
+        {
+            token.type = TokenType::OPERATOR;
+            token.op = readOperator(str+i, size-i, token.length);
+
+            if(token.op == Operator::NONE)
+                return false;
+        }
+
+        tokens.push_back(token);
+        i += token.length;
+    }
+
+    return true;
+}
+
+/** \brief check if a token is a given identifier.
+ */
+static inline bool isIdentifier(const Token& token, const char* str, std::size_t size)
+{
+    return token.type == TokenType::IDENTIFIER && token.length == size && std::strncmp(token.text, str, size) == 0;
+}
+
+/**< expands the macros of a stream of tokens, like the preprocessor does. */
+class TokenExpander
+{
+public:
+    TokenExpander(const MacroContainer& macroContainer, const std::vector< std::pair<std::string, std::string> >* redef,
+                  std::vector<std::string>& expandedMacros)
+    : macroContainer(macroContainer), redef(redef), expandedMacros(expandedMacros), active()
+    {}
+
+    /** \brief expand the macros of a sequence of tokens.
+     *
+     * \param first the first token of the sequence.
+     * \param last the end of the sequence.
+     * \param output the tokens once expanded are appended to it, identifiers that are not macros become booleans ("true", "false").
+     * \return false if a macro can't be expanded for sure (undefined, defined several times, recursive...).
+     */
+    bool expand(const Token* first, const Token* last, std::vector<Token>& output)
+    {
+        for(const Token* it=first; it!=last; ++it)
+        {
+            if(output.size() > TOKENEVAL_MAX_TOKENS)
+                return false;
+
+            if(it->type != TokenType::IDENTIFIER){
+                output.push_back(*it);
+                continue;
+            }
+
+            std::string name(it->text, it->length);
+
+            // A macro can't be expanded inside itself
+            if(std::find(active.begin(), active.end(), name) != active.end() || active.size() >= TOKENEVAL_MAX_DEPTH)
+                return false;
+
+            functionLike.clear();
+            macroContainer.listNamesStartingWith(name+'(', objectLike, functionLike);
+
+            const auto& dictionary = macroContainer.getDefines();
+            auto range = dictionary.equal_range(name);
+
+            if(range.first != range.second)
+            {
+                const std::string* value = chooseDefinition(name, range.first, range.second);
+
+                // Both a macro with parameters and another one without, we don't know which one is meant
+                if(!value || !functionLike.empty())
+                    return false;
+
+                std::vector<Token> body;
+                if(!tokenize(value->data(), value->size(), body))
+                    return false;
+
+                emplaceOnce(expandedMacros, name);
+
+                active.push_back(std::move(name));
+                bool expanded = expand(body.data(), body.data()+body.size(), output);
+                active.pop_back();
+
+                if(!expanded)
+                    return false;
+            }
+            else if(!functionLike.empty())
+            {
+                if(functionLike.size() != 1 || !expandWithParameters(*functionLike.front(), it, last, output))
+                    return false;
+            }
+            else if(isIdentifier(*it, "true", 4) || isIdentifier(*it, "false", 5))
+            {
+                Token token = { TokenType::BOOLEAN, Operator::NONE, it->text, it->length, { it->length == 4, false } };
+                output.push_back(token);
+            }
+            else
+            {
+                // Undefined identifier
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    /** \brief choose the definition of a macro: the one imposed by redef if any, the only one otherwise.
+     *
+     * \return the value chosen, nullptr if the macro has several definitions and none is imposed.
+     */
+    template<typename Iterator>
+    const std::string* chooseDefinition(const std::string& name, Iterator first, Iterator last) const
+    {
+        const std::string* value = nullptr;
+
+        if(redef)
+        {
+            for(const auto& p: *redef){
+                if(p.first == name)
+                    value = &p.second;
+            }
+        }
+
+        if(!value && std::next(first) == last)
+            value = &first->second;
+
+        return value;
+    }
+
+    /** \brief expand a macro with parameters, the arguments are expanded before being substituted.
+     *
+     * \param macroName the name of the macro with its parameters, for instance "MAX(a,b)".
+     * \param it the token of the name in the expression, it is moved to the closing parenthesis of the arguments.
+     * \param last the end of the sequence being expanded.
+     */
+    bool expandWithParameters(const std::string& macroName, const Token*& it, const Token* last, std::vector<Token>& output)
+    {
+        const auto& dictionary = macroContainer.getDefines();
+        auto range = dictionary.equal_range(macroName);
+
+        const std::string* value = chooseDefinition(macroName, range.first, range.second);
+        if(!value)
+            return false;
+
+        // Let's read the names of the parameters
+        std::vector<Token> parameters;
+        std::size_t posPar = macroName.find('(');
+        if(macroName.back() != ')' || !tokenize(macroName.data()+posPar+1, macroName.size()-posPar-2, parameters))
+            return false;
+
+        std::vector<const Token*> names;
+        for(std::size_t i=0; i<parameters.size(); i+=2)
+        {
+            if(parameters[i].type != TokenType::IDENTIFIER
+            || (i+1 < parameters.size() && parameters[i+1].op != Operator::COMMA))
+                return false;
+            names.push_back(&parameters[i]);
+        }
+
+        if(!parameters.empty() && parameters.back().type != TokenType::IDENTIFIER)
+            return false;
+
+        // Let's read the arguments, they must all be inside the sequence
+        const Token* current = it+1;
+        if(current == last || current->op != Operator::OPEN_PAR)
+            return false;
+
+        std::vector< std::vector<Token> > arguments;
+        const Token* argumentStart = ++current;
+        int level = 0;
+
+        for(; current != last; ++current)
+        {
+            if(current->op == Operator::OPEN_PAR)
+                ++level;
+            else if(current->op == Operator::CLOSE_PAR && level > 0)
+                --level;
+            else if(level == 0 && (current->op == Operator::COMMA || current->op == Operator::CLOSE_PAR))
+            {
+                arguments.emplace_back();
+                if(!expand(argumentStart, current, arguments.back()))
+                    return false;
+
+                argumentStart = current+1;
+
+                if(current->op == Operator::CLOSE_PAR)
+                    break;
+            }
+        }
+
+        if(current == last)
+            return false;
+
+        // "F()" is called with one empty argument
+        if(names.empty() && arguments.size() == 1 && arguments.front().empty())
+            arguments.clear();
+
+        if(arguments.size() != names.size())
+            return false;
+
+        // Let's substitute the parameters
+        std::vector<Token> body;
+        if(!tokenize(value->data(), value->size(), body))
+            return false;
+
+        std::vector<Token> substituted;
+        for(const Token& token: body)
+        {
+            std::size_t k = 0;
+            while(k < names.size() && !isIdentifier(token, names[k]->text, names[k]->length))
+                ++k;
+
+            if(k < names.size())
+                substituted.insert(substituted.end(), arguments[k].begin(), arguments[k].end());
+            else
+                substituted.push_back(token);
+        }
+
+        // Finally the result is expanded again
+        active.emplace_back(macroName, 0, posPar);
+        bool expanded = expand(substituted.data(), substituted.data()+substituted.size(), output);
+        active.pop_back();
+
+        it = current;
+        return expanded;
+    }
+
+    const MacroContainer& macroContainer;
+    const std::vector< std::pair<std::string, std::string> >* redef;
+    std::vector<std::string>& expandedMacros;
+
+    /**< the names of the macros being expanded. */
+    std::vector<std::string> active;
+
+    /**< buffers used to look for the macros with parameters. */
+    std::vector<const std::string*> objectLike, functionLike;
+};
+
+/**< computes the value of a stream of tokens with a precedence-climbing parser (C semantics over 64-bit integers). */
+class TokenParser
+{
+public:
+    explicit TokenParser(const std::vector<Token>& tokens)
+    : tokens(tokens), position(0)
+    {}
+
+    /** \brief compute the value of the whole stream.
+     *
+     * \return false if the expression is incorrect, or if its value can't be known for sure (division by zero...).
+     */
+    bool parse(Value& result)
+    {
+        return parseConditional(result, true) && position == tokens.size();
+    }
+
+private:
+    static bool isTrue(const Value& v)
+    {
+        return v.number.isTrue();
+    }
+
+    /** \brief the precedence of a binary operator, 0 if it is not one.
+     */
+    static int precedence(Operator op)
+    {
+        switch(op)
+        {
+            case Operator::LOGICAL_OR: return 1;
+            case Operator::LOGICAL_AND: return 2;
+            case Operator::BIT_OR: return 3;
+            case Operator::BIT_XOR: return 4;
+            case Operator::BIT_AND: return 5;
+            case Operator::EQUAL: case Operator::NOT_EQUAL: return 6;
+            case Operator::LESS: case Operator::GREATER: case Operator::LESS_EQUAL: case Operator::GREATER_EQUAL: return 7;
+            case Operator::SHIFT_LEFT: case Operator::SHIFT_RIGHT: return 8;
+            case Operator::PLUS: case Operator::MINUS: return 9;
+            case Operator::MULTIPLY: case Operator::DIVIDE: case Operator::MODULO: return 10;
+            default: return 0;
+        }
+    }
+
+    bool accept(Operator op)
+    {
+        if(position < tokens.size() && tokens[position].type == TokenType::OPERATOR && tokens[position].op == op){
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    /** \brief parse "condition ? a : b", only the branch chosen has to be computable.
+     *
+     * \param evaluated false inside a branch that is not taken (its errors are ignored, like in C).
+     */
+    bool parseConditional(Value& result, bool evaluated)
+    {
+        if(!parseBinary(result, 1, evaluated))
+            return false;
+
+        if(!accept(Operator::QUESTION))
+            return true;
+
+        Value first, second;
+        const bool condition = isTrue(result);
+
+        if(!parseConditional(first, evaluated && condition) || !accept(Operator::COLON)
+        || !parseConditional(second, evaluated && !condition))
+            return false;
+
+        result = (condition ? first : second);
+        return true;
+    }
+
+    bool parseBinary(Value& left, int minPrecedence, bool evaluated)
+    {
+        if(!parseUnary(left, evaluated))
+            return false;
+
+        while(position < tokens.size() && tokens[position].type == TokenType::OPERATOR)
+        {
+            const Operator op = tokens[position].op;
+            const int prec = precedence(op);
+
+            if(prec == 0 || prec < minPrecedence)
+                break;
+
+            ++position;
+
+            // Short-circuit evaluation of the logical operators
+            bool rightEvaluated = evaluated;
+            if(op == Operator::LOGICAL_AND)
+                rightEvaluated = evaluated && isTrue(left);
+            else if(op == Operator::LOGICAL_OR)
+                rightEvaluated = evaluated && !isTrue(left);
+
+            Value right;
+            if(!parseBinary(right, prec+1, rightEvaluated) || !applyBinary(op, left, right, evaluated))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool parseUnary(Value& result, bool evaluated)
+    {
+        if(position >= tokens.size())
+            return false;
+
+        const Token& token = tokens[position++];
+
+        if(token.type == TokenType::NUMBER || token.type == TokenType::BOOLEAN){
+            result.number = token.value;
+            result.isBoolean = (token.type == TokenType::BOOLEAN);
+            return true;
+        }
+
+        if(token.type != TokenType::OPERATOR)
+            return false;
+
+        if(token.op == Operator::OPEN_PAR)
+            return parseConditional(result, evaluated) && accept(Operator::CLOSE_PAR);
+
+        if(token.op != Operator::PLUS && token.op != Operator::MINUS && token.op != Operator::LOGICAL_NOT && token.op != Operator::BIT_NOT)
+            return false;
+
+        if(!parseUnary(result, evaluated))
+            return false;
+
+        if(token.op == Operator::LOGICAL_NOT){
+            result.number.bits = !isTrue(result);
+            result.number.isUnsigned = false;
+            result.isBoolean = true;
+            return true;
+        }
+
+        // The arithmetic operators don't apply to booleans
+        if(result.isBoolean)
+            return !evaluated;
+
+        if(token.op == Operator::MINUS)
+            negateInteger(result.number);
+        else if(token.op == Operator::BIT_NOT)
+            complementInteger(result.number);
+
+        return true;
+    }
+
+    /** \brief the operator of the integer arithmetic corresponding to a binary operator (logical operators excepted).
+     */
+    static ArithmeticOperator toArithmeticOperator(Operator op)
+    {
+        switch(op)
+        {
+            case Operator::PLUS: return ArithmeticOperator::PLUS;
+            case Operator::MINUS: return ArithmeticOperator::MINUS;
+            case Operator::MULTIPLY: return ArithmeticOperator::MULTIPLY;
+            case Operator::DIVIDE: return ArithmeticOperator::DIVIDE;
+            case Operator::MODULO: return ArithmeticOperator::MODULO;
+            case Operator::SHIFT_LEFT: return ArithmeticOperator::SHIFT_LEFT;
+            case Operator::SHIFT_RIGHT: return ArithmeticOperator::SHIFT_RIGHT;
+            case Operator::LESS: return ArithmeticOperator::LESS;
+            case Operator::GREATER: return ArithmeticOperator::GREATER;
+            case Operator::LESS_EQUAL: return ArithmeticOperator::LESS_EQUAL;
+            case Operator::GREATER_EQUAL: return ArithmeticOperator::GREATER_EQUAL;
+            case Operator::EQUAL: return ArithmeticOperator::EQUAL;
+            case Operator::NOT_EQUAL: return ArithmeticOperator::NOT_EQUAL;
+            case Operator::BIT_AND: return ArithmeticOperator::BIT_AND;
+            case Operator::BIT_XOR: return ArithmeticOperator::BIT_XOR;
+            default: return ArithmeticOperator::BIT_OR;
+        }
+    }
+
+    /** \brief compute "left op right", the result is stored in left.
+     */
+    static bool applyBinary(Operator op, Value& left, const Value& right, bool evaluated)
+    {
+        const bool isComparison = (precedence(op) == 6 || precedence(op) == 7);
+
+        if(op == Operator::LOGICAL_AND || op == Operator::LOGICAL_OR)
+        {
+            left.number.bits = (op == Operator::LOGICAL_AND ? isTrue(left) && isTrue(right) : isTrue(left) || isTrue(right));
+            left.number.isUnsigned = false;
+            left.isBoolean = true;
+            return true;
+        }
+
+        // Nothing else than the result type matters in a branch that is not evaluated
+        if(!evaluated)
+        {
+            left.number.bits = 0;
+            left.number.isUnsigned = false;
+            left.isBoolean = isComparison;
+            return true;
+        }
+
+        // Booleans can only be compared to booleans, and numbers to numbers
+        if(op == Operator::EQUAL || op == Operator::NOT_EQUAL)
+        {
+            if(left.isBoolean != right.isBoolean)
+                return false;
+        }
+        else if(left.isBoolean || right.isBoolean)
+            return false;
+
+        // The arithmetic is the one of the preprocessor (division by zero or shift too large can't be computed)
+        if(!applyArithmeticOperator(toArithmeticOperator(op), left.number, right.number))
+            return false;
+
+        left.isBoolean = isComparison;
+        return true;
+    }
+
+    const std::vector<Token>& tokens;
+    std::size_t position;
+};
+
+bool evaluateTokens(std::string& expr, const MacroContainer& macroContainer,
+                    const std::vector< std::pair<std::string, std::string> >* redef, std::vector<std::string>* expandedMacros,
+                    IntegerValue* number)
+{
+    std::vector<Token> tokens;
+    if(!tokenize(expr.data(), expr.size(), tokens))
+        return false;
+
+    // The names are only reported if the evaluation succeeds
+    std::vector<std::string> expandedNames;
+    TokenExpander expander(macroContainer, redef, expandedNames);
+
+    std::vector<Token> expanded;
+    expanded.reserve(tokens.size());
+    if(!expander.expand(tokens.data(), tokens.data()+tokens.size(), expanded))
+        return false;
+
+    Value result;
+    TokenParser parser(expanded);
+    if(!parser.parse(result))
+        return false;
+
+    if(expandedMacros)
+    {
+        for(std::string& name: expandedNames)
+            emplaceOnce(*expandedMacros, std::move(name));
+    }
+
+    if(result.isBoolean)
+        expr = (result.number.isTrue() ? "true" : "false");
+    else
+        expr = integerToString(result.number);
+
+    if(number && !result.isBoolean)
+        *number = result.number;
+
+    return true;
+}
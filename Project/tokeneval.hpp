@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    tokeneval.hpp
+  * @author  MCD Application Team
+  * @brief   Macro-Parser
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef TOKENEVAL_HPP
+#define TOKENEVAL_HPP
+
+/// This file describes the evaluation of expressions on tokens.
+/// The expression is tokenized once, the macros are expanded on the stream of tokens,
+/// and the result is computed by a precedence-climbing parser over integer and boolean values.
+/// It only handles the expressions whose value is certain, the other ones are left to calculateExpression.
+
+#include <vector>
+#include <string>
+
+#include "container.hpp"
+#include "arithmetic.hpp"
+
+/** \brief evaluate an expression on tokens.
+ *
+ * \param expr the expression, it is replaced by its value (a number, "true" or "false") if the evaluation succeeds.
+ * \param macroContainer the macros used to evaluate the expression.
+ * \param redef the definitions to be used for macros that are defined several times (can be nullptr).
+ * \param expandedMacros if not nullptr, the names of the macros without parameters expanded are added once to this array.
+ * \param number if not nullptr, it receives the value with its type when the result is an integer (it is left unchanged for a boolean).
+ * \return true if the expression was evaluated, false if it has to be evaluated by calculateExpression (expr is unchanged then).
+ */
+bool evaluateTokens(std::string& expr, const MacroContainer& macroContainer,
+                    const std::vector< std::pair<std::string, std::string> >* redef, std::vector<std::string>* expandedMacros,
+                    IntegerValue* number=nullptr);
+
+#endif // TOKENEVAL_HPP